@@ -0,0 +1,529 @@
+/*
+ * Host renderer: runs effects on a Linux machine and streams the finished
+ * frames to one or more logos over DDP, which then only drive their pixels.
+ * - Links the firmware's Arduino-free modules: the radar and rainbow
+ *   effects, spiral geometry, image and GIF sampling, the post chain and
+ *   trails, so those look as they do on the logo itself. The noise effect
+ *   lives only here; it is too heavy for the ESP32 at frame rate.
+ * - Frames are paced at --fps from a steady clock. Each device gets the
+ *   same frame, split into DDP packets with the push flag on the last.
+ * - A logo that stops receiving falls back to its own effect after a
+ *   second, so stopping the daemon (Ctrl-C, SIGTERM) is always safe.
+ *
+ *   pio run -e renderd && .pio/build/renderd/program --device 192.168.1.50 --effect noise
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "ddp.h"
+#include "effects.h"
+#include "gif_player.h"
+#include "lookup_tables.h"
+#include "post_filter.h"
+#include "spiral_geometry.h"
+#include "spiral_image.h"
+#include "strip_config.h"
+#include "trails.h"
+
+namespace
+{
+  constexpr uint8_t MaxDevices = 16;
+  constexpr uint8_t NoiseOctaves = 5;
+  constexpr float NoiseScale = 3.0f;   // Features across the spiral's diameter
+  constexpr float NoiseSpeed = 0.25f;  // Noise-space units per second
+  constexpr uint32_t ReportEveryMs = 5000;
+
+  enum class Effect
+  {
+    Rainbow,
+    Radar,
+    Noise,
+    Image,
+    Gif
+  };
+
+  const char *const EffectNames[] = {"rainbow", "radar", "noise", "image", "gif"};
+
+  struct Rgb
+  {
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+  };
+
+  constexpr Rgb RadarColor = {255, 192, 64}; // Amber
+
+  struct Options
+  {
+    sockaddr_in devices[MaxDevices];
+    uint8_t deviceCount = 0;
+    uint16_t pixels = MaxPixelCount;
+    uint16_t fps = 60;
+    Effect effect = Effect::Noise;
+    const char *file = nullptr; // Binary PPM for image, GIF for gif
+    uint16_t spinMs = 0;
+    uint8_t brightness = 255;
+    uint8_t trails = 0;
+    const char *post = "off";
+    uint32_t frames = 0; // 0 runs until stopped
+  };
+
+  volatile sig_atomic_t stopping = 0;
+
+  class FileGifReader : public GifReader
+  {
+  public:
+    FILE *file = nullptr;
+
+    size_t read(uint8_t *buffer, size_t length) override { return fread(buffer, 1, length, file); }
+    bool seek(uint32_t position) override { return fseek(file, position, SEEK_SET) == 0; }
+  };
+
+  SpiralGeometry geometry;
+  SpiralImage image;
+  GifPlayer gif;
+  FileGifReader gifFile;
+  PostChain postChain;
+  effects::Radar radar;
+
+  // "host" or "host:port"; the port defaults to DDP's.
+  bool parseDevice(const char *text, sockaddr_in &address)
+  {
+    char host[256];
+    strncpy(host, text, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    uint16_t port = ddp::Port;
+    char *colon = strrchr(host, ':');
+    if (colon)
+    {
+      *colon = '\0';
+      port = static_cast<uint16_t>(strtoul(colon + 1, nullptr, 10));
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *found = nullptr;
+    if (!port || getaddrinfo(host, nullptr, &hints, &found) != 0)
+    {
+      return false;
+    }
+    address = *reinterpret_cast<sockaddr_in *>(found->ai_addr);
+    address.sin_port = htons(port);
+    freeaddrinfo(found);
+    return true;
+  }
+
+  bool parseEffect(const char *name, Effect &effect)
+  {
+    for (uint8_t index = 0; index < sizeof(EffectNames) / sizeof(EffectNames[0]); ++index)
+    {
+      if (strcmp(name, EffectNames[index]) == 0)
+      {
+        effect = static_cast<Effect>(index);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool parseOptions(int argc, char **argv, Options &options)
+  {
+    for (int index = 1; index < argc; ++index)
+    {
+      const char *name = argv[index];
+      const char *value = index + 1 < argc ? argv[index + 1] : nullptr;
+      if (!value)
+      {
+        return false;
+      }
+      ++index;
+
+      if (strcmp(name, "--device") == 0)
+      {
+        if (options.deviceCount == MaxDevices || !parseDevice(value, options.devices[options.deviceCount]))
+        {
+          fprintf(stderr, "bad or too many devices: %s\n", value);
+          return false;
+        }
+        ++options.deviceCount;
+      }
+      else if (strcmp(name, "--effect") == 0)
+      {
+        if (!parseEffect(value, options.effect))
+        {
+          return false;
+        }
+      }
+      else if (strcmp(name, "--pixels") == 0)
+      {
+        options.pixels = static_cast<uint16_t>(strtoul(value, nullptr, 10));
+      }
+      else if (strcmp(name, "--fps") == 0)
+      {
+        options.fps = static_cast<uint16_t>(strtoul(value, nullptr, 10));
+      }
+      else if (strcmp(name, "--file") == 0)
+      {
+        options.file = value;
+      }
+      else if (strcmp(name, "--spin") == 0)
+      {
+        options.spinMs = static_cast<uint16_t>(strtoul(value, nullptr, 10));
+      }
+      else if (strcmp(name, "--brightness") == 0)
+      {
+        options.brightness = static_cast<uint8_t>(strtoul(value, nullptr, 10));
+      }
+      else if (strcmp(name, "--trails") == 0)
+      {
+        options.trails = static_cast<uint8_t>(strtoul(value, nullptr, 10));
+      }
+      else if (strcmp(name, "--post") == 0)
+      {
+        options.post = value;
+      }
+      else if (strcmp(name, "--frames") == 0)
+      {
+        options.frames = strtoul(value, nullptr, 10);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    bool needsFile = options.effect == Effect::Image || options.effect == Effect::Gif;
+    return options.deviceCount && options.pixels >= 1 && options.pixels <= MaxPixelCount && options.fps >= 1 &&
+           options.fps <= 1000 && (!needsFile || options.file);
+  }
+
+  // Binary PPM ("P6"), as written by `convert art.png -resize 64x64 art.ppm`.
+  bool loadImage(const char *path)
+  {
+    FILE *file = fopen(path, "rb");
+    unsigned width = 0;
+    unsigned height = 0;
+    unsigned maxValue = 0;
+    bool loaded = file && fscanf(file, "P6 %u %u %u", &width, &height, &maxValue) == 3 && maxValue == 255 &&
+                  fgetc(file) != EOF && image.begin(static_cast<uint8_t>(width > 255 ? 0 : width),
+                                                    static_cast<uint8_t>(height > 255 ? 0 : height));
+    if (loaded)
+    {
+      std::vector<uint8_t> rgb(image.uploadByteCount());
+      loaded = fread(rgb.data(), 1, rgb.size(), file) == rgb.size() && image.write(0, rgb.data(), rgb.size()) &&
+               image.finish();
+    }
+    if (file)
+    {
+      fclose(file);
+    }
+    if (!loaded)
+    {
+      fprintf(stderr, "%s: not a binary PPM of at most %ux%u\n", path, SpiralImage::MaxSide, SpiralImage::MaxSide);
+    }
+    return loaded;
+  }
+
+  bool openGif(const char *path)
+  {
+    gifFile.file = fopen(path, "rb");
+    if (!gifFile.file || !gif.open(gifFile) || !gif.decodeFrame())
+    {
+      fprintf(stderr, "%s: not a usable GIF (up to %ux%u)\n", path, GifPlayer::MaxSide, GifPlayer::MaxSide);
+      return false;
+    }
+    return true;
+  }
+
+  // Smooth pseudo-random values on an integer lattice, interpolated with a
+  // smoothstep in three dimensions (x, y and time).
+  float lattice(int32_t x, int32_t y, int32_t z)
+  {
+    uint32_t hash = static_cast<uint32_t>(x) * 0x8DA6B343u ^ static_cast<uint32_t>(y) * 0xD8163841u ^
+                    static_cast<uint32_t>(z) * 0xCB1AB31Fu;
+    hash ^= hash >> 13;
+    hash *= 0x5BD1E995u;
+    hash ^= hash >> 15;
+    return (hash & 0xFFFF) / 65535.0f;
+  }
+
+  float valueNoise(float x, float y, float z)
+  {
+    int32_t ix = static_cast<int32_t>(floorf(x));
+    int32_t iy = static_cast<int32_t>(floorf(y));
+    int32_t iz = static_cast<int32_t>(floorf(z));
+    float fx = x - ix;
+    float fy = y - iy;
+    float fz = z - iz;
+    fx = fx * fx * (3 - 2 * fx);
+    fy = fy * fy * (3 - 2 * fy);
+    fz = fz * fz * (3 - 2 * fz);
+
+    float plane[2];
+    for (int32_t layer = 0; layer < 2; ++layer)
+    {
+      float near = lattice(ix, iy, iz + layer) + (lattice(ix + 1, iy, iz + layer) - lattice(ix, iy, iz + layer)) * fx;
+      float far = lattice(ix, iy + 1, iz + layer) +
+                  (lattice(ix + 1, iy + 1, iz + layer) - lattice(ix, iy + 1, iz + layer)) * fx;
+      plane[layer] = near + (far - near) * fy;
+    }
+    return plane[0] + (plane[1] - plane[0]) * fz;
+  }
+
+  // Octaves halve in size and weight; the result stays within 0-1.
+  float fractalNoise(float x, float y, float z)
+  {
+    float sum = 0;
+    float weight = 0.5f;
+    float total = 0;
+    for (uint8_t octave = 0; octave < NoiseOctaves; ++octave)
+    {
+      sum += valueNoise(x, y, z) * weight;
+      total += weight;
+      x *= 2;
+      y *= 2;
+      weight *= 0.5f;
+    }
+    return sum / total;
+  }
+
+  // Noise picks a hue and a level for each LED from its place on the spiral.
+  void renderNoise(Rgb *frame, uint16_t count, double seconds)
+  {
+    float z = static_cast<float>(seconds * NoiseSpeed);
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
+    {
+      const PolarPoint &point = geometry.point(pixel);
+      float theta = point.angle * (6.2831853f / 65536.0f);
+      float radius = point.radius / 255.0f;
+      float x = cosf(theta) * radius * NoiseScale;
+      float y = sinf(theta) * radius * NoiseScale;
+      float hue = fractalNoise(x, y, z);
+      float level = fractalNoise(x + 37.0f, y - 11.0f, z * 1.5f);
+      const lut::Rgb8 &color = lut::HueWheel[static_cast<uint32_t>(hue * 511.0f) & 0xFF]; // Two turns
+      uint8_t dim = lut::Brightness[static_cast<uint8_t>(level * level * 255.0f)];
+      frame[pixel] = {static_cast<uint8_t>(color.r * dim >> 8), static_cast<uint8_t>(color.g * dim >> 8),
+                      static_cast<uint8_t>(color.b * dim >> 8)};
+    }
+  }
+
+  void renderRainbow(Rgb *frame, uint16_t count)
+  {
+    effects::renderRainbow(0, count, count, [frame](uint16_t pixel, const lut::Rgb8 &hue)
+                           { frame[pixel] = {hue.r, hue.g, hue.b}; });
+  }
+
+  // In RadarColor, dimmed as RgbColor::Dim does on the logo.
+  void renderRadar(Rgb *frame, uint32_t nowMs)
+  {
+    radar.render(geometry, effects::radarLead(nowMs), [frame](uint16_t pixel, uint8_t level)
+                 {
+      uint16_t factor = level + 1;
+      frame[pixel] = {static_cast<uint8_t>(RadarColor.R * factor >> 8), static_cast<uint8_t>(RadarColor.G * factor >> 8),
+                      static_cast<uint8_t>(RadarColor.B * factor >> 8)}; });
+  }
+
+  void renderImage(Rgb *frame, uint16_t count, uint32_t nowMs, uint16_t spinMs)
+  {
+    uint16_t rotation = spinMs ? static_cast<uint16_t>(nowMs % spinMs * 65536UL / spinMs) : 0;
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
+    {
+      lut::Rgb8 color = spinMs ? image.sampleRotated(pixel, rotation) : image.sampleScrolled(pixel, 0);
+      frame[pixel] = {color.r, color.g, color.b};
+    }
+  }
+
+  // Decodes as many GIF frames as are due; a long stall skips ahead rather
+  // than playing catch-up.
+  void renderGif(Rgb *frame, uint16_t count, uint32_t nowMs, uint32_t &dueMs)
+  {
+    if (static_cast<int32_t>(nowMs - dueMs) >= 0)
+    {
+      if (!gif.decodeFrame())
+      {
+        stopping = 1;
+        return;
+      }
+      dueMs = nowMs - dueMs > 1000 ? nowMs : dueMs;
+      dueMs += gif.frameDelayMs() ? gif.frameDelayMs() : 100;
+    }
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
+    {
+      lut::Rgb8 color = gif.sample(pixel);
+      frame[pixel] = {color.r, color.g, color.b};
+    }
+  }
+
+  void applyBrightness(Rgb *frame, uint16_t count, uint8_t brightness)
+  {
+    uint16_t factor = lut::Brightness[brightness] + 1;
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
+    {
+      Rgb &color = frame[pixel];
+      color = {static_cast<uint8_t>(color.R * factor >> 8), static_cast<uint8_t>(color.G * factor >> 8),
+               static_cast<uint8_t>(color.B * factor >> 8)};
+    }
+  }
+
+  // One frame to every device: DDP packets of up to MaxData bytes, the
+  // sequence counting 1-15 per device.
+  void sendFrame(int socket, const Options &options, const Rgb *frame, uint8_t *sequences)
+  {
+    const uint32_t bytes = static_cast<uint32_t>(options.pixels) * 3;
+    uint8_t packet[ddp::HeaderSize + ddp::MaxData];
+    for (uint8_t device = 0; device < options.deviceCount; ++device)
+    {
+      for (uint32_t offset = 0; offset < bytes; offset += ddp::MaxData)
+      {
+        uint16_t length = static_cast<uint16_t>(bytes - offset < ddp::MaxData ? bytes - offset : ddp::MaxData);
+        uint8_t &sequence = sequences[device];
+        sequence = sequence == 15 ? 1 : sequence + 1;
+        size_t header = ddp::writeHeader(packet, sequence, offset, length, offset + length == bytes);
+        memcpy(packet + header, reinterpret_cast<const uint8_t *>(frame) + offset, length);
+        sendto(socket, packet, header + length, 0, reinterpret_cast<const sockaddr *>(&options.devices[device]),
+               sizeof(sockaddr_in));
+      }
+    }
+  }
+
+  void stop(int)
+  {
+    stopping = 1;
+  }
+}
+
+static_assert(sizeof(Rgb) == 3, "frames are sent straight from the Rgb array");
+
+int main(int argc, char **argv)
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    fprintf(stderr,
+            "usage: %s --device HOST[:PORT] [--device ...] [--effect rainbow|radar|noise|image|gif] [--file PATH]\n"
+            "          [--pixels N] [--fps N] [--spin MS] [--brightness N] [--trails N] [--post SPEC] [--frames N]\n",
+            argv[0]);
+    return 2;
+  }
+  if (!postChain.configure(options.post, 128))
+  {
+    fprintf(stderr, "bad post chain: %s\n", options.post);
+    return 2;
+  }
+
+  // Bound first, as on the device: loading places the samples for this geometry.
+  geometry.build(options.pixels);
+  image.bind(geometry);
+  gif.bind(geometry);
+  if ((options.effect == Effect::Image && !loadImage(options.file)) ||
+      (options.effect == Effect::Gif && !openGif(options.file)))
+  {
+    return 1;
+  }
+
+  int sender = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sender < 0)
+  {
+    perror("socket");
+    return 1;
+  }
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  std::vector<Rgb> frame(options.pixels);
+  std::vector<Rgb> history(options.pixels);
+  std::vector<Rgb> output(options.pixels);
+  uint8_t sequences[MaxDevices] = {};
+  uint32_t gifDueMs = gif.frameDelayMs(); // openGif() decoded the first frame
+
+  using Clock = std::chrono::steady_clock;
+  const Clock::duration period = std::chrono::nanoseconds(1000000000LL / options.fps);
+  const Clock::time_point start = Clock::now();
+  Clock::time_point next = start;
+  Clock::time_point reportAt = start + std::chrono::milliseconds(ReportEveryMs);
+  double renderNs = 0;
+  uint32_t reportFrames = 0;
+  uint32_t late = 0;
+
+  printf("streaming %s to %u device(s): %u pixels at %u fps\n", EffectNames[static_cast<int>(options.effect)],
+         options.deviceCount, options.pixels, options.fps);
+  for (uint32_t index = 0; !stopping && (!options.frames || index < options.frames); ++index)
+  {
+    Clock::time_point frameStart = Clock::now();
+    double seconds = std::chrono::duration<double>(frameStart - start).count();
+    uint32_t nowMs = static_cast<uint32_t>(seconds * 1000);
+
+    switch (options.effect)
+    {
+    case Effect::Rainbow:
+      renderRainbow(frame.data(), options.pixels);
+      break;
+    case Effect::Radar:
+      renderRadar(frame.data(), nowMs);
+      break;
+    case Effect::Noise:
+      renderNoise(frame.data(), options.pixels, seconds);
+      break;
+    case Effect::Image:
+      renderImage(frame.data(), options.pixels, nowMs, options.spinMs);
+      break;
+    case Effect::Gif:
+      renderGif(frame.data(), options.pixels, nowMs, gifDueMs);
+      break;
+    }
+    applyBrightness(frame.data(), options.pixels, options.brightness);
+
+    const Rgb *finished = frame.data();
+    if (options.trails)
+    {
+      trails::fold(finished, history.data(), options.pixels, options.trails);
+      finished = history.data();
+    }
+    if (postChain.active())
+    {
+      postChain.apply(finished, output.data(), options.pixels);
+      finished = output.data();
+    }
+    sendFrame(sender, options, finished, sequences);
+    renderNs += std::chrono::duration<double, std::nano>(Clock::now() - frameStart).count();
+    ++reportFrames;
+
+    next += period;
+    Clock::time_point now = Clock::now();
+    if (now > next)
+    {
+      ++late;
+      next = now; // Don't burst to catch up
+    }
+    if (now >= reportAt)
+    {
+      printf("%.1f fps, %.3f ms/frame rendering and sending, %u late\n",
+             reportFrames * 1000.0 / ReportEveryMs, renderNs / reportFrames / 1e6, late);
+      fflush(stdout);
+      reportAt += std::chrono::milliseconds(ReportEveryMs);
+      renderNs = 0;
+      reportFrames = 0;
+      late = 0;
+    }
+    std::this_thread::sleep_until(next);
+  }
+
+  close(sender);
+  if (gifFile.file)
+  {
+    fclose(gifFile.file);
+  }
+  return 0;
+}
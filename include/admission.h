@@ -0,0 +1,78 @@
+/*
+ * HTTP admission control that keeps request handling from starving the
+ * render loop.
+ * - Token buckets per client (IPv4 address, small LRU table) and globally.
+ * - A cap on requests in flight, with the last slots reserved for control.
+ * - Request classes in priority order: control > state polls > static files.
+ *   Lower classes are shed first as render-loop slack shrinks, and the
+ *   global refill rate scales with slack too.
+ * - Slack is fed from the render task (recordFrame) and read on the
+ *   async_tcp task; everything else runs on async_tcp only.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum class RequestClass : uint8_t
+{
+  Control, // Changes what the light does; never shed for slack
+  State,   // API reads, polled by every open UI
+  Static   // UI files from SPIFFS
+};
+
+class AdmissionControl
+{
+public:
+  static constexpr uint8_t MaxClients = 16;
+  static constexpr uint8_t MaxInFlight = 8;
+  static constexpr uint8_t ControlReserve = 2;   // In-flight slots only control may use
+  static constexpr uint16_t ClientRate = 8;      // Requests per second per client
+  static constexpr uint16_t ClientBurst = 24;    // A UI page load is ~4 requests
+  static constexpr uint16_t GlobalRate = 40;     // Requests per second at full slack
+  static constexpr uint16_t GlobalBurst = 60;
+  static constexpr uint8_t StateMinSlack = 15;   // Percent of the frame budget
+  static constexpr uint8_t StaticMinSlack = 35;
+
+  explicit AdmissionControl(uint32_t frameBudgetUs) : frameBudgetUs(frameBudgetUs) {}
+
+  // Render task: time the frame used, counting how late it started.
+  void recordFrame(uint32_t usedUs);
+
+  // async_tcp: admit() counts the request in flight until release().
+  bool admit(uint32_t client, RequestClass kind, uint32_t nowMs);
+  void release();
+
+  uint8_t slackPercent() const { return slack; }
+  uint8_t inFlight() const { return active; }
+  uint32_t rejected() const { return rejectedCount; }
+
+private:
+  static constexpr uint16_t TokenScale = 1000; // Buckets hold milli-tokens
+
+  struct Bucket
+  {
+    uint32_t tokens = 0;
+    uint32_t refilledMs = 0;
+  };
+
+  struct Client
+  {
+    uint32_t address = 0;
+    Bucket bucket;
+    uint32_t lastSeenMs = 0;
+  };
+
+  static void refill(Bucket &bucket, uint32_t nowMs, uint32_t perSecond, uint16_t burst);
+  Client &clientFor(uint32_t address, uint32_t nowMs);
+  bool reject();
+
+  uint32_t frameBudgetUs;
+  uint32_t averageUsedUs = 0;
+  volatile uint8_t slack = 100;
+
+  Bucket global{GlobalBurst * TokenScale, 0};
+  Client clients[MaxClients];
+  uint8_t active = 0;
+  uint32_t rejectedCount = 0;
+};
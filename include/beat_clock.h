@@ -0,0 +1,46 @@
+/*
+ * BPM clock for tempo-following effects.
+ * - Set from tap-tempo or an explicit BPM; BPM is kept in hundredths.
+ * - update() is called once per frame and caches the beat count and a 16-bit
+ *   phase within the beat, so every effect reads the same frame-accurate
+ *   value without doing the division itself.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class BeatClock
+{
+public:
+  static constexpr uint16_t MinCentiBpm = 2000;  // 20 BPM
+  static constexpr uint16_t MaxCentiBpm = 30000; // 300 BPM
+  static constexpr uint8_t MaxTaps = 8;
+  static constexpr uint16_t TapTimeoutMs = 2000; // A longer gap starts a new tap run
+
+  // Changes tempo without jumping the phase of the current beat.
+  void setBpm(uint16_t centiBpm, uint32_t nowMs);
+  // Registers a tap; from the second tap on, tempo follows the average
+  // interval and the beat lands on the tap.
+  void tap(uint32_t nowMs);
+  void stop() { centiBpm = 0; }
+
+  void update(uint32_t nowMs);
+
+  bool isRunning() const { return centiBpm != 0; }
+  uint16_t bpm100() const { return centiBpm; }
+  uint32_t beat() const { return beatCount; }
+  uint16_t phase() const { return beatPhase; } // 0-65535 across one beat
+  uint8_t phase8() const { return beatPhase >> 8; }
+  uint32_t periodMs() const { return centiBpm ? 6000000UL / centiBpm : 0; }
+
+private:
+  uint32_t position(uint32_t nowMs) const; // Beats since anchor, 16.16 fixed point
+
+  uint16_t centiBpm = 0;
+  uint32_t anchorMs = 0;
+  uint32_t taps[MaxTaps] = {};
+  uint8_t tapCount = 0;
+  uint32_t beatCount = 0;
+  uint16_t beatPhase = 0;
+};
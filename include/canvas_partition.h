@@ -0,0 +1,94 @@
+/*
+ * One canvas partitioned across several controllers.
+ * - Node i of n drives canvas pixels [i * count, (i + 1) * count); every node
+ *   has the same logical count, so the canvas grows by one strip per node
+ *   while each node still renders only its own pixels. Parameters and the
+ *   show clock are shared the usual way (/api/control, showtime).
+ * - The post chain reads up to PostChain::HaloWidth pixels past each end of
+ *   a slice. Each node broadcasts its two edges and keeps the latest edges
+ *   of its two neighbours; an edge not heard for MaxAge frames is dropped and
+ *   the end pixel is repeated instead, as on a single strip.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "post_filter.h"
+
+struct CanvasSlice
+{
+  uint8_t node = 0;
+  uint8_t nodes = 1;
+  uint16_t count = 0; // Logical pixels on this node
+
+  uint32_t offset() const { return static_cast<uint32_t>(node) * count; }
+  uint32_t canvasCount() const { return static_cast<uint32_t>(nodes) * count; }
+  bool partitioned() const { return nodes > 1; }
+  bool hasLeft() const { return node > 0; }
+  bool hasRight() const { return node + 1 < nodes; }
+};
+
+// Halo packet: 'H', node count, sender, sequence (little endian), width,
+// then the sender's first and last `width` pixels as RGB.
+class HaloExchange
+{
+public:
+  static constexpr uint8_t MaxNodes = 32;
+  static constexpr uint8_t Width = PostChain::HaloWidth;
+  static constexpr uint8_t HeaderSize = 6;
+  static constexpr size_t PacketSize = HeaderSize + 2 * Width * 3;
+  static constexpr uint8_t MaxAge = 12; // Frames
+
+  // Works on any colour with R, G and B byte members. A slice shorter than
+  // Width repeats its end pixel.
+  template <typename Color>
+  static size_t encode(const CanvasSlice &slice, uint16_t sequence, const Color *pixels, uint8_t *packet)
+  {
+    const uint8_t header[HeaderSize] = {'H', slice.nodes, slice.node, static_cast<uint8_t>(sequence),
+                                        static_cast<uint8_t>(sequence >> 8), Width};
+    uint8_t *out = packet;
+    for (uint8_t byte : header)
+    {
+      *out++ = byte;
+    }
+    for (uint8_t edge = 0; edge < 2; ++edge)
+    {
+      for (uint8_t index = 0; index < Width; ++index)
+      {
+        uint16_t pixel = static_cast<uint16_t>(edge ? slice.count - Width + index : index);
+        const Color &color = pixels[pixel < slice.count ? pixel : (edge ? 0 : slice.count - 1)];
+        *out++ = color.R;
+        *out++ = color.G;
+        *out++ = color.B;
+      }
+    }
+    return PacketSize;
+  }
+
+  // Which neighbour sent `packet`: -1 left, 1 right, 0 neither.
+  static int8_t side(const CanvasSlice &slice, const uint8_t *packet, size_t length);
+  static uint16_t sequence(const uint8_t *packet) { return packet[3] | packet[4] << 8; }
+
+  // Keeps the edge that faces this slice. True if the halo changed.
+  bool receive(const CanvasSlice &slice, const uint8_t *packet, size_t length);
+
+  // Once per frame. True if a halo just expired.
+  bool advance();
+  void clear();
+
+  // HaloWidth pixels as RGB bytes in canvas order, or nullptr.
+  const uint8_t *left() const { return leftAge < MaxAge ? leftEdge : nullptr; }
+  const uint8_t *right() const { return rightAge < MaxAge ? rightEdge : nullptr; }
+  uint16_t leftSequence() const { return leftSeq; }
+  uint16_t rightSequence() const { return rightSeq; }
+
+private:
+  uint8_t leftEdge[Width * 3] = {};
+  uint8_t rightEdge[Width * 3] = {};
+  uint8_t leftAge = MaxAge;
+  uint8_t rightAge = MaxAge;
+  uint16_t leftSeq = 0;
+  uint16_t rightSeq = 0;
+};
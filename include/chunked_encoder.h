@@ -0,0 +1,101 @@
+/*
+ * Produces an encoded payload incrementally for chunked HTTP responses.
+ * - The payload is described by a source callable, bool(Writer &, uint16_t
+ *   step), that writes one piece per step (an opening, one list entry, a
+ *   closing...) and returns false after the last piece.
+ * - Pieces go through a small fixed buffer and are copied into whatever
+ *   space the TCP send path offers, so memory stays constant however long
+ *   the payload is. A piece longer than BufferSize is sent a buffer at a
+ *   time: its step runs again from the same nesting state, skipping what
+ *   has been sent, so each piece must write the same bytes every time.
+ * - A writer error other than a full buffer (JSON nested too deep) ends
+ *   the payload where it happened.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+template <typename Writer, typename Source>
+class ChunkedEncoder
+{
+public:
+  static constexpr size_t BufferSize = 128;
+
+  explicit ChunkedEncoder(Source source) : source(source) {}
+  ChunkedEncoder(const ChunkedEncoder &) = delete; // writers point into buffer
+  ChunkedEncoder &operator=(const ChunkedEncoder &) = delete;
+
+  // Fills up to `capacity` bytes of `out`; returns 0 once the payload is done.
+  size_t fill(uint8_t *out, size_t capacity)
+  {
+    size_t written = 0;
+    while (written < capacity)
+    {
+      if (drained == writer.length())
+      {
+        if (!nextWindow())
+        {
+          break;
+        }
+        continue;
+      }
+
+      size_t count = writer.length() - drained;
+      if (count > capacity - written)
+      {
+        count = capacity - written;
+      }
+      memcpy(out + written, writer.bytes() + drained, count);
+      drained += count;
+      written += count;
+    }
+    return written;
+  }
+
+private:
+  // Encodes the rest of a piece that filled the buffer, or else the next
+  // piece. False once the payload is done.
+  bool nextWindow()
+  {
+    if (pieceContinues)
+    {
+      writer = pieceStart;
+      writer.skip(pieceSent);
+      finished = !source(writer, step - 1);
+    }
+    else
+    {
+      if (finished)
+      {
+        return false;
+      }
+      writer.rewind();
+      pieceStart = writer;
+      pieceSent = 0;
+      finished = !source(writer, step++);
+    }
+
+    drained = 0;
+    pieceContinues = writer.overflowed() && writer.length() == BufferSize;
+    if (writer.overflowed() && !pieceContinues)
+    {
+      finished = true;
+      writer.rewind();
+    }
+    pieceSent += writer.length();
+    return true;
+  }
+
+  Source source;
+  uint8_t buffer[BufferSize];
+  Writer writer{buffer, BufferSize};
+  Writer pieceStart{buffer, BufferSize}; // Nesting state before the current piece
+  size_t pieceSent = 0;
+  bool pieceContinues = false;
+  size_t drained = 0;
+  uint16_t step = 0;
+  bool finished = false;
+};
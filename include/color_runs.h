@@ -0,0 +1,43 @@
+/*
+ * Colour kernels over runs of packed 0x00RRGGBB pixels, for frames stored
+ *   packed: the native simulator runs a whole camp through them.
+ * - The firmware does not call them; its frames are RgbColor, folded by
+ *   trails::fold and dimmed by RgbColor::Dim. trail and dim give the same
+ *   bits as those per channel; blend and add have no firmware counterpart.
+ * - Builds with AVX2 or SSE2 available (the native env) use vector paths;
+ *   others get the scalar path, built on the packed_color.h kernels.
+ * - runs::scalar is always compiled and is the reference: every vector path
+ *   must give the same bits (the simulator's --check compares them).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace runs
+{
+  // Each channel * (level + 1) / 256, like RgbColor::Dim.
+  void dim(uint32_t *pixels, size_t count, uint8_t level);
+
+  // target = target + (source - target) * (progress + 1) / 256.
+  void blend(uint32_t *target, const uint32_t *source, size_t count, uint8_t progress);
+
+  // target = min(target + source, 255) per channel.
+  void add(uint32_t *target, const uint32_t *source, size_t count);
+
+  // history = max(frame, history * decay / 256) per channel; true while any
+  // pixel of history is still brighter than frame (a trail is fading).
+  bool trail(uint32_t *history, const uint32_t *frame, size_t count, uint8_t decay);
+
+  // "avx2", "sse2" or "scalar".
+  const char *backend();
+
+  namespace scalar
+  {
+    void dim(uint32_t *pixels, size_t count, uint8_t level);
+    void blend(uint32_t *target, const uint32_t *source, size_t count, uint8_t progress);
+    void add(uint32_t *target, const uint32_t *source, size_t count);
+    bool trail(uint32_t *history, const uint32_t *frame, size_t count, uint8_t decay);
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * Blackbody colour temperature to strip RGB.
+ * - The table is built at compile time from Tanner Helland's fit of the
+ *   Planckian locus, converted from sRGB to linear LED drive (gamma 2.2) and
+ *   scaled by the strip white balance, so a lookup is ready to send.
+ * - 100 K steps from 1800 K to 6500 K; values in between are interpolated.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "lookup_tables.h"
+#include "strip_config.h"
+
+namespace kelvin
+{
+  constexpr uint16_t Min = 1800;
+  constexpr uint16_t Max = 6500;
+  constexpr uint16_t Step = 100;
+  constexpr size_t EntryCount = (Max - Min) / Step + 1;
+
+  constexpr double clampChannel(double value)
+  {
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+  }
+
+  constexpr lut::Rgb8 blackbody(double kelvin)
+  {
+    double t = kelvin / 100.0;
+    double r = t <= 66 ? 255 : 329.698727446 * lut::power(t - 60, -0.1332047592);
+    double g = t <= 66 ? 99.4708025861 * lut::logarithm(t) - 161.1195681661
+                       : 288.1221695283 * lut::power(t - 60, -0.0755148492);
+    double b = t >= 66 ? 255 : t <= 19 ? 0 : 138.5177312231 * lut::logarithm(t - 10) - 305.0447927307;
+
+    // sRGB-ish fit -> linear drive -> strip white balance.
+    auto toStrip = [](double value, uint8_t calibration)
+    {
+      return lut::roundToByte(255.0 * lut::power(clampChannel(value) / 255.0, 2.2) * calibration / 255.0);
+    };
+    return {toStrip(r, CalibrationRed), toStrip(g, CalibrationGreen), toStrip(b, CalibrationBlue)};
+  }
+
+  constexpr lut::Table<lut::Rgb8, EntryCount> makeTable()
+  {
+    lut::Table<lut::Rgb8, EntryCount> table = {};
+    for (size_t i = 0; i < EntryCount; ++i)
+    {
+      table.values[i] = blackbody(Min + i * Step);
+    }
+    return table;
+  }
+
+  inline constexpr lut::Table<lut::Rgb8, EntryCount> Table = makeTable();
+
+  static_assert(Table[0].r == CalibrationRed && Table[0].b == 0, "1800 K is red-orange with no blue");
+  static_assert(Table[EntryCount - 1].b > Table[0].b && Table[EntryCount - 1].g > Table[0].g,
+                "hotter temperatures are bluer");
+
+  inline lut::Rgb8 toRgb(uint16_t kelvin)
+  {
+    kelvin = kelvin < Min ? Min : kelvin > Max ? Max : kelvin;
+    uint16_t offset = kelvin - Min;
+    size_t index = offset / Step;
+    if (index + 1 >= EntryCount)
+    {
+      return Table[EntryCount - 1];
+    }
+
+    uint8_t weight = static_cast<uint8_t>((offset % Step) * 256 / Step);
+    const lut::Rgb8 &low = Table[index];
+    const lut::Rgb8 &high = Table[index + 1];
+    auto mix = [weight](uint8_t a, uint8_t b)
+    { return static_cast<uint8_t>(a + (((static_cast<int16_t>(b) - a) * weight) >> 8)); };
+    return {mix(low.r, high.r), mix(low.g, high.g), mix(low.b, high.b)};
+  }
+}
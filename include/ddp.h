@@ -0,0 +1,70 @@
+/*
+ * DDP (Distributed Display Protocol) framing for streamed frames.
+ * - 10-byte header: flags (version 1, push on the last packet of a frame),
+ *   a 4-bit sequence (0 = unused), data type, destination id, then the
+ *   byte offset and length of the data, both big-endian. A timecode flag
+ *   adds 4 bytes, which are skipped.
+ * - Only 8-bit RGB data is used. Frames longer than one packet are split by
+ *   offset; the receiver assembles them and hands over a frame on push.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "strip_config.h"
+
+namespace ddp
+{
+  constexpr uint16_t Port = 4048;
+  constexpr uint8_t HeaderSize = 10;
+  constexpr uint8_t TimecodeSize = 4;
+  constexpr uint8_t Version1 = 0x40;
+  constexpr uint8_t VersionMask = 0xC0;
+  constexpr uint8_t Timecode = 0x10;
+  constexpr uint8_t Push = 0x01;
+  constexpr uint8_t TypeRgb8 = 0x0B;
+  constexpr uint8_t DisplayId = 1;
+  constexpr uint16_t MaxData = 1440; // 480 pixels; keeps a packet inside one Ethernet frame
+
+  // Fills `packet` with a header for `length` bytes at `offset`; returns
+  // HeaderSize. The data goes right after it.
+  size_t writeHeader(uint8_t *packet, uint8_t sequence, uint32_t offset, uint16_t length, bool push);
+
+  struct Packet
+  {
+    uint8_t sequence;
+    bool push;
+    uint32_t offset;
+    uint16_t length;
+    const uint8_t *data;
+  };
+
+  // False unless a version 1 RGB packet whose data fits in `size`.
+  bool parse(const uint8_t *packet, size_t size, Packet &out);
+
+  // Assembles one strip's frames. Data past MaxPixelCount pixels is ignored.
+  class Receiver
+  {
+  public:
+    static constexpr uint16_t Capacity = MaxPixelCount * 3;
+
+    // True when the packet completes a frame (push), which data() and
+    // length() then hold until the next packet.
+    bool receive(const uint8_t *packet, size_t size);
+
+    const uint8_t *data() const { return frame; }
+    uint16_t length() const { return frameLength; }
+    uint32_t frames() const { return frameCount; }
+    uint32_t lost() const { return lostCount; } // Packets missing from the sequence
+
+  private:
+    uint8_t frame[Capacity] = {};
+    uint16_t frameLength = 0;
+    uint16_t assembled = 0;
+    uint8_t lastSequence = 0;
+    uint32_t frameCount = 0;
+    uint32_t lostCount = 0;
+  };
+}
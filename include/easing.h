@@ -0,0 +1,139 @@
+/*
+ * Easing curves for fades and transitions.
+ * - Each curve is a 256-entry constexpr table mapping linear progress to
+ *   eased progress, both 0-255, so evaluating one is a single flash load.
+ * - Evaluate once per frame and blend with the result; never per pixel.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lookup_tables.h"
+
+enum class Easing : uint8_t
+{
+  Linear,
+  InQuad,
+  OutQuad,
+  InOutQuad,
+  InCubic,
+  OutCubic,
+  InOutCubic,
+  InOutSine,
+  InExpo,
+  OutExpo,
+  InOutExpo,
+  Count
+};
+
+namespace easing
+{
+  constexpr double curve(Easing easing, double t)
+  {
+    switch (easing)
+    {
+    case Easing::InQuad:
+      return t * t;
+    case Easing::OutQuad:
+      return 1 - (1 - t) * (1 - t);
+    case Easing::InOutQuad:
+      return t < 0.5 ? 2 * t * t : 1 - 2 * (1 - t) * (1 - t);
+    case Easing::InCubic:
+      return t * t * t;
+    case Easing::OutCubic:
+      return 1 - (1 - t) * (1 - t) * (1 - t);
+    case Easing::InOutCubic:
+      return t < 0.5 ? 4 * t * t * t : 1 - 4 * (1 - t) * (1 - t) * (1 - t);
+    case Easing::InOutSine:
+      return (1 - lut::sine(lut::Pi * t + lut::Pi / 2)) / 2;
+    case Easing::InExpo:
+      return t <= 0 ? 0 : lut::power(2.0, 10 * t - 10);
+    case Easing::OutExpo:
+      return t >= 1 ? 1 : 1 - lut::power(2.0, -10 * t);
+    case Easing::InOutExpo:
+      return t <= 0 ? 0 : t >= 1 ? 1 : t < 0.5 ? lut::power(2.0, 20 * t - 10) / 2 : (2 - lut::power(2.0, 10 - 20 * t)) / 2;
+    default:
+      return t;
+    }
+  }
+
+  constexpr lut::Table<uint8_t, 256> makeCurve(Easing easing)
+  {
+    lut::Table<uint8_t, 256> table = {};
+    for (size_t i = 0; i < 256; ++i)
+    {
+      table.values[i] = lut::roundToByte(255.0 * curve(easing, i / 255.0));
+    }
+    return table;
+  }
+
+  inline constexpr lut::Table<uint8_t, 256> Curves[] = {
+      makeCurve(Easing::Linear),
+      makeCurve(Easing::InQuad),
+      makeCurve(Easing::OutQuad),
+      makeCurve(Easing::InOutQuad),
+      makeCurve(Easing::InCubic),
+      makeCurve(Easing::OutCubic),
+      makeCurve(Easing::InOutCubic),
+      makeCurve(Easing::InOutSine),
+      makeCurve(Easing::InExpo),
+      makeCurve(Easing::OutExpo),
+      makeCurve(Easing::InOutExpo),
+  };
+
+  inline constexpr const char *Names[] = {
+      "linear", "in-quad", "out-quad", "in-out-quad", "in-cubic", "out-cubic",
+      "in-out-cubic", "in-out-sine", "in-expo", "out-expo", "in-out-expo",
+  };
+
+  static_assert(sizeof(Curves) / sizeof(Curves[0]) == static_cast<size_t>(Easing::Count), "one table per curve");
+  static_assert(sizeof(Names) / sizeof(Names[0]) == static_cast<size_t>(Easing::Count), "one name per curve");
+
+  constexpr bool curvesAreWellFormed()
+  {
+    for (const auto &table : Curves)
+    {
+      if (table[0] != 0 || table[255] != 255 || !lut::isMonotonic(table))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static_assert(curvesAreWellFormed(), "easing curves must run 0 -> 255 monotonically");
+  static_assert(Curves[static_cast<size_t>(Easing::Linear)][128] == 128, "linear is identity");
+  static_assert(Curves[static_cast<size_t>(Easing::InOutSine)][128] == 128, "in-out curves cross the midpoint");
+
+  constexpr uint8_t ease(Easing easing, uint8_t progress)
+  {
+    return Curves[static_cast<size_t>(easing)][progress];
+  }
+
+  // Adapter for NeoPixelAnimator's float progress.
+  inline uint8_t ease(Easing easing, float progress)
+  {
+    float clamped = progress < 0.0f ? 0.0f : progress > 1.0f ? 1.0f : progress;
+    return ease(easing, static_cast<uint8_t>(clamped * 255.0f + 0.5f));
+  }
+
+  inline const char *name(Easing easing)
+  {
+    return Names[static_cast<size_t>(easing)];
+  }
+
+  inline bool fromName(const char *text, Easing &easing)
+  {
+    for (size_t i = 0; i < static_cast<size_t>(Easing::Count); ++i)
+    {
+      if (strcmp(text, Names[i]) == 0)
+      {
+        easing = static_cast<Easing>(i);
+        return true;
+      }
+    }
+    return false;
+  }
+}
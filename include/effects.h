@@ -0,0 +1,79 @@
+/*
+ * Effects shared by the firmware, the native simulator and the render
+ * daemon, so all three draw the same thing.
+ * - Renderers know nothing about colour types: they hand each pixel to a
+ *   paint callable, which stores it as RgbColor, packed words or DDP bytes.
+ * - Radar: a beam rotating about the centre of the spiral with a fading
+ *   tail. Only pixels inside the beam, and those that just left it, are
+ *   painted, so the frame must keep what was painted last time.
+ * - Rainbow: one static turn of the hue wheel along the spiral, or along
+ *   the whole canvas when it is partitioned.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "lookup_tables.h"
+#include "spiral_geometry.h"
+
+namespace effects
+{
+  constexpr uint16_t RadarPeriodMs = 2000;   // One revolution; one per beat when following the beat
+  constexpr uint16_t RadarBeamWidth = 12000; // Fading tail behind the beam, in 1/65536 turns
+
+  // Beam angle `nowMs` into a free-running revolution.
+  uint16_t radarLead(uint32_t nowMs);
+
+  // Level of a pixel at `angle` with the beam at `lead`, ready for a Dim()
+  // (channel * (level + 1) / 256): gamma-corrected, 0 outside the beam's
+  // arc [lead - RadarBeamWidth, lead).
+  uint8_t radarLevel(uint16_t lead, uint16_t angle);
+
+  class Radar
+  {
+  public:
+    // The next render repaints every pixel (new effect, new geometry).
+    void restart() { started = false; }
+
+    // paint(pixel, level) with the level from radarLevel(); 0 is off.
+    template <typename Paint>
+    void render(const SpiralGeometry &geometry, uint16_t lead, Paint paint)
+    {
+      uint16_t tail = lead - RadarBeamWidth;
+      if (!started || static_cast<uint16_t>(lead - drawnLead) > RadarBeamWidth)
+      {
+        // First frame, or the beam jumped (beat sync toggled): nothing to carry over.
+        for (uint16_t pixel = 0; pixel < geometry.count(); ++pixel)
+        {
+          paint(pixel, 0);
+        }
+      }
+      else
+      {
+        geometry.forEachInArc(drawnLead - RadarBeamWidth, tail, [&](uint16_t pixel)
+                              { paint(pixel, 0); });
+      }
+      started = true;
+      drawnLead = lead;
+
+      geometry.forEachInArc(tail, lead, [&](uint16_t pixel)
+                            { paint(pixel, radarLevel(lead, geometry.point(pixel).angle)); });
+    }
+
+  private:
+    uint16_t drawnLead = 0; // Beam angle drawn last frame
+    bool started = false;
+  };
+
+  // paint(pixel, hue) for the `count` pixels starting at canvas position
+  // `offset` of `canvasCount`.
+  template <typename Paint>
+  void renderRainbow(uint32_t offset, uint16_t count, uint32_t canvasCount, Paint paint)
+  {
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
+    {
+      paint(pixel, lut::HueWheel[((offset + pixel) * 256) / canvasCount]);
+    }
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * Structured writers for API responses: JSON, CBOR (RFC 8949) and
+ * MessagePack, all with the same calls so one function can describe a
+ * payload once and emit any of the three.
+ * - Writers fill a caller-owned fixed buffer; nothing is allocated. On
+ *   overflow, or JSON nested deeper than JsonWriter::MaxDepth, they stop
+ *   writing and report overflowed().
+ * - Maps and arrays must declare their entry count up front (binary
+ *   formats encode it in the header); JSON ignores it.
+ * - rewind() empties the buffer but keeps nesting state, so one payload can
+ *   be produced piece by piece through a small buffer (chunked_encoder.h);
+ *   skip() drops leading bytes, so a piece longer than the buffer can be
+ *   written again for its next window.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class EncodeBuffer
+{
+public:
+  EncodeBuffer(uint8_t *buffer, size_t capacity) : data(buffer), capacity(capacity) {}
+
+  const uint8_t *bytes() const { return data; }
+  size_t length() const { return used; }
+  bool overflowed() const { return overflow; }
+  void rewind()
+  {
+    used = 0;
+    skipped = 0;
+    overflow = false;
+  }
+  void skip(size_t count) { skipped = count; } // The next `count` bytes written are dropped
+
+protected:
+  void put(uint8_t byte);
+  void put(const void *bytes, size_t count);
+  void fail() { overflow = true; }
+
+private:
+  uint8_t *data;
+  size_t capacity;
+  size_t used = 0;
+  size_t skipped = 0;
+  bool overflow = false;
+};
+
+class JsonWriter : public EncodeBuffer
+{
+public:
+  using EncodeBuffer::EncodeBuffer;
+
+  void beginMap(uint8_t entries);
+  void endMap() { close('}'); }
+  void beginArray(uint16_t entries);
+  void endArray() { close(']'); }
+  void key(const char *name);
+  void text(const char *value);
+  void unsignedInt(uint32_t value);
+  void integer(int32_t value);
+  void boolean(bool value);
+  void decimal(float value); // Two decimal places
+
+  static constexpr uint8_t MaxDepth = 8;
+
+private:
+  void separate();
+  void open(char bracket);
+  void close(char bracket);
+
+  uint8_t depth = 0;
+  bool first[MaxDepth] = {};
+  bool afterKey = false;
+};
+
+class CborWriter : public EncodeBuffer
+{
+public:
+  using EncodeBuffer::EncodeBuffer;
+
+  void beginMap(uint8_t entries) { head(5, entries); }
+  void endMap() {}
+  void beginArray(uint16_t entries) { head(4, entries); }
+  void endArray() {}
+  void key(const char *name) { text(name); }
+  void text(const char *value);
+  void unsignedInt(uint32_t value) { head(0, value); }
+  void integer(int32_t value);
+  void boolean(bool value) { put(value ? 0xF5 : 0xF4); }
+  void decimal(float value);
+
+private:
+  void head(uint8_t majorType, uint32_t value);
+};
+
+class MsgPackWriter : public EncodeBuffer
+{
+public:
+  using EncodeBuffer::EncodeBuffer;
+
+  void beginMap(uint8_t entries);
+  void endMap() {}
+  void beginArray(uint16_t entries);
+  void endArray() {}
+  void key(const char *name) { text(name); }
+  void text(const char *value);
+  void unsignedInt(uint32_t value);
+  void integer(int32_t value);
+  void boolean(bool value) { put(value ? 0xC3 : 0xC2); }
+  void decimal(float value);
+};
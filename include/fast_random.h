@@ -0,0 +1,55 @@
+/*
+ * Small seedable PRNG for effects.
+ * - xorshift32: three shifts and three xors per draw, no division.
+ * - Each effect owns its own instance, so the same seed replays the same
+ *   sequence regardless of what other effects or the network stack draw.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class FastRandom
+{
+public:
+  explicit FastRandom(uint32_t seed = 1) { reseed(seed); }
+
+  // Scrambles the seed (splitmix32 finaliser) so nearby seeds diverge at once.
+  void reseed(uint32_t seed)
+  {
+    seedValue = seed;
+    uint32_t z = seed + 0x9E3779B9u;
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    z ^= z >> 16;
+    state = z ? z : 0x6D2B79F5u; // xorshift must never hold zero
+  }
+
+  uint32_t seed() const { return seedValue; }
+
+  uint32_t next()
+  {
+    uint32_t x = state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    return x;
+  }
+
+  // Uniform in [0, bound) via multiply-shift instead of modulo.
+  uint32_t below(uint32_t bound)
+  {
+    return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32);
+  }
+
+  // Uniform in [low, high), mirroring Arduino random(low, high).
+  int32_t between(int32_t low, int32_t high)
+  {
+    return high > low ? low + static_cast<int32_t>(below(static_cast<uint32_t>(high - low))) : low;
+  }
+
+private:
+  uint32_t state;
+  uint32_t seedValue;
+};
@@ -0,0 +1,40 @@
+/*
+ * Frame jitter meter for the render task.
+ * - record() takes each frame's deviation from the nominal frame period;
+ *   a 50 us histogram gives the 99th percentile without storing samples.
+ * - Results are published per window of WindowFrames frames, so a reading
+ *   always covers the same span and old load doesn't linger in it.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+struct JitterResult
+{
+  uint32_t p99Us = 0;
+  uint32_t maxUs = 0;
+  uint32_t meanUs = 0;
+  uint16_t frames = 0; // 0 until a full window has been measured
+};
+
+class JitterMeter
+{
+public:
+  static constexpr uint8_t BucketCount = 64;
+  static constexpr uint16_t BucketUs = 50; // Last bucket collects everything past 3.15 ms
+  static constexpr uint16_t WindowFrames = 600;
+
+  // Returns true when this sample completed a window; see last().
+  bool record(uint32_t deviationUs);
+  void reset();
+
+  const JitterResult &last() const { return result; }
+
+private:
+  uint16_t buckets[BucketCount] = {};
+  uint16_t count = 0;
+  uint32_t sumUs = 0;
+  uint32_t maxUs = 0;
+  JitterResult result;
+};
@@ -0,0 +1,149 @@
+/*
+ * Streaming animated-GIF player for the spiral.
+ * - Frames are LZW-decoded straight from the file one sub-block at a time.
+ *   No frame buffer is kept: only the canvas texels under the pixels'
+ *   sample points are stored. Rows without sample points are decoded and
+ *   thrown away.
+ * - Sample points come from the spiral geometry (four per pixel for
+ *   bilinear filtering) and are indexed by canvas row, so matching a
+ *   decoded pixel to its points is a cursor step, interlaced rows included.
+ * - Handles local palettes, transparency and all disposal methods on those
+ *   points, and loops back to the first frame at the trailer.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lookup_tables.h"
+#include "spiral_geometry.h"
+
+// Where the player reads from; a SPIFFS file on the device.
+class GifReader
+{
+public:
+  virtual size_t read(uint8_t *buffer, size_t length) = 0;
+  virtual bool seek(uint32_t position) = 0;
+
+protected:
+  ~GifReader() = default;
+};
+
+class GifPlayer
+{
+public:
+  static constexpr uint16_t MaxSide = 512;
+  static constexpr uint16_t MaxCodes = 4096;
+  static constexpr uint16_t PointCount = MaxPixelCount * 4;
+
+  // Reads the header and global palette; false if not a usable GIF.
+  bool open(GifReader &reader);
+  void close() { source = nullptr; }
+  bool isOpen() const { return source != nullptr; }
+
+  // Recomputes sample points; call when the geometry changes.
+  void bind(const SpiralGeometry &geometry);
+
+  // Decodes the next frame (looping at the end) into the sample points.
+  // False on a truncated or corrupt file, which also closes the player.
+  bool decodeFrame();
+
+  uint16_t width() const { return canvasWidth; }
+  uint16_t height() const { return canvasHeight; }
+  uint16_t frameDelayMs() const { return delayMs; }
+
+  lut::Rgb8 sample(uint16_t logical) const;
+
+private:
+  enum class Disposal : uint8_t
+  {
+    Keep,
+    Background,
+    Previous
+  };
+
+  struct Point
+  {
+    uint16_t x;
+    uint16_t y;
+  };
+
+  struct Weights
+  {
+    uint8_t fx;
+    uint8_t fy;
+  };
+
+  bool readBytes(uint8_t *buffer, size_t length);
+  bool readByte(uint8_t &value) { return readBytes(&value, 1); }
+  bool rewind();
+  bool readPalette(lut::Rgb8 *palette, uint8_t flags);
+  bool skipSubBlocks();
+  bool readGraphicControl();
+  bool decodeImage();
+  bool nextCode(uint16_t &code);
+  void emit(uint8_t index);
+  void startRow();
+  void nextRow();
+  void disposePrevious();
+  void placePoints();
+  void resetCanvas();
+  bool fail();
+
+  // Reads are batched; SPIFFS is slow per call.
+  GifReader *source = nullptr;
+  uint8_t input[64] = {};
+  uint8_t inputLength = 0;
+  uint8_t inputOffset = 0;
+  uint32_t consumed = 0;
+  uint32_t firstFrameAt = 0;
+  bool framesSinceRewind = false;
+  uint16_t canvasWidth = 0;
+  uint16_t canvasHeight = 0;
+  lut::Rgb8 globalPalette[256] = {};
+  lut::Rgb8 localPalette[256] = {};
+  const lut::Rgb8 *palette = globalPalette;
+  bool hasGlobalPalette = false;
+
+  // Graphic control for the frame being decoded, and the one before it.
+  uint16_t delayMs = 100;
+  bool transparent = false;
+  uint8_t transparentIndex = 0;
+  Disposal disposal = Disposal::Keep;
+  Disposal lastDisposal = Disposal::Keep;
+  uint16_t lastLeft = 0, lastTop = 0, lastWidth = 0, lastHeight = 0;
+
+  // Current frame rectangle and output position.
+  uint16_t frameLeft = 0, frameTop = 0, frameWidth = 0, frameHeight = 0;
+  bool interlaced = false;
+  uint8_t pass = 0;
+  uint16_t row = 0; // Frame row being written
+  uint16_t column = 0;
+  uint32_t pixelsLeft = 0;
+  uint16_t cursor = 0; // Next sample point in the current row
+  uint16_t rowEnd = 0;
+
+  // LZW state; the bit reader pulls one data sub-block at a time.
+  uint16_t prefix[MaxCodes] = {};
+  uint8_t suffix[MaxCodes] = {};
+  uint8_t stack[MaxCodes] = {};
+  uint8_t block[255] = {};
+  uint8_t blockLength = 0;
+  uint8_t blockOffset = 0;
+  bool blocksEnded = false;
+  uint32_t bitBuffer = 0;
+  uint8_t bitCount = 0;
+  uint8_t codeSize = 0;
+
+  // Sample points: ordered by (row, column), rowStart indexes into order.
+  PolarPoint positions[MaxPixelCount] = {};
+  uint16_t positionCount = 0;
+  Point points[PointCount] = {};
+  uint16_t order[PointCount] = {};
+  uint16_t rowStart[MaxSide + 1] = {};
+  uint16_t rowFill[MaxSide] = {}; // placePoints() scratch, kept off the render task's stack
+  Weights weights[MaxPixelCount] = {};
+  lut::Rgb8 canvas[PointCount] = {};
+  lut::Rgb8 saved[PointCount] = {}; // For "restore to previous" disposal
+};
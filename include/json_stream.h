@@ -0,0 +1,125 @@
+/*
+ * Streaming (SAX-style) JSON parser for HTTP request bodies.
+ * - Feed body chunks as they arrive; each scalar is reported to a handler
+ *   together with its path, so values go straight into typed structs.
+ * - Bounded memory: fixed nesting depth, key length and token length, all
+ *   inside the parser object. Nothing is allocated or buffered per body.
+ * - Strings and numbers are handed out NUL-terminated from the token buffer;
+ *   longer tokens are an error rather than being truncated silently. Keys
+ *   longer than MaxKeyLength are not an error: they read as "", which no
+ *   handler field matches, so their values are skipped.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class JsonType : uint8_t
+{
+  String,
+  Number,
+  Bool,
+  Null
+};
+
+struct JsonValue
+{
+  JsonType type = JsonType::Null;
+  const char *text = ""; // String contents, or the number literal as written
+  uint8_t length = 0;
+  int32_t integer = 0; // Numbers truncated towards zero and clamped to int32
+  bool boolean = false;
+};
+
+class JsonStreamParser;
+
+class JsonHandler
+{
+public:
+  virtual void onValue(const JsonStreamParser &parser, const JsonValue &value) = 0;
+
+protected:
+  ~JsonHandler() = default;
+};
+
+class JsonStreamParser
+{
+public:
+  static constexpr uint8_t MaxDepth = 6;
+  static constexpr uint8_t MaxKeyLength = 16; // "overlayLatencyUs", the longest key /api/state writes
+  static constexpr uint8_t MaxTokenLength = 47;
+
+  enum class Status : uint8_t
+  {
+    Parsing,
+    Done,
+    Error
+  };
+
+  explicit JsonStreamParser(JsonHandler &handler) : handler(handler) {}
+
+  void reset();
+  Status feed(const uint8_t *data, size_t length);
+  Status finish(); // Call after the last chunk; completes a trailing number
+  Status status() const { return state; }
+  size_t errorOffset() const { return errorAt; }
+
+  // Path of the value being reported: depth() open containers, each either
+  // an object (key(level)) or an array (index(level)).
+  uint8_t depth() const { return level; }
+  bool inArray(uint8_t at) const { return at < level && arrays[at]; }
+  const char *key(uint8_t at) const { return at < level && !arrays[at] ? keys[at] : ""; }
+  uint16_t index(uint8_t at) const { return at < level ? indices[at] : 0; }
+
+private:
+  enum class Expect : uint8_t
+  {
+    Value,
+    KeyOrEnd,
+    Key,
+    Colon,
+    CommaOrEnd,
+    End
+  };
+
+  enum class Lexeme : uint8_t
+  {
+    None,
+    String,
+    Escape,
+    Unicode,
+    Number,
+    Literal
+  };
+
+  bool step(uint8_t byte);
+  bool startValue(uint8_t byte);
+  bool closeContainer(bool array);
+  bool finishValue();
+  bool pushToken(uint8_t byte);
+  bool pushCodePoint(uint16_t codePoint);
+  bool endString();
+  bool endNumber();
+  bool endLiteral();
+  Status fail();
+
+  JsonHandler &handler;
+  Status state = Status::Parsing;
+  Expect expect = Expect::Value;
+  Lexeme lexeme = Lexeme::None;
+  size_t offset = 0;
+  size_t errorAt = 0;
+
+  uint8_t level = 0;
+  bool arrays[MaxDepth] = {};
+  char keys[MaxDepth][MaxKeyLength + 1] = {};
+  uint16_t indices[MaxDepth] = {};
+
+  char token[MaxTokenLength + 1] = {};
+  uint8_t tokenLength = 0;
+  bool readingKey = false;
+  bool keyTooLong = false;
+  uint16_t codePoint = 0;
+  uint8_t hexDigits = 0;
+};
@@ -0,0 +1,250 @@
+/*
+ * Lookup tables generated at compile time.
+ * - Every table is a constexpr array, so it lands in flash (.rodata) and boot
+ *   does no work to build it.
+ * - The generators use small series expansions instead of <cmath>, which is
+ *   not constexpr; the static_asserts at the bottom bound their error.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace lut
+{
+  template <typename T, size_t N>
+  struct Table
+  {
+    T values[N];
+
+    constexpr const T &operator[](size_t index) const { return values[index]; }
+    static constexpr size_t size() { return N; }
+  };
+
+  struct Rgb8
+  {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+  };
+
+  // --- constexpr math -----------------------------------------------------
+
+  constexpr double Pi = 3.14159265358979323846;
+
+  constexpr double absolute(double x) { return x < 0 ? -x : x; }
+
+  constexpr uint8_t roundToByte(double x)
+  {
+    return x <= 0.0 ? 0 : x >= 255.0 ? 255 : static_cast<uint8_t>(x + 0.5);
+  }
+
+  // Taylor series after folding x into [-pi/2, pi/2]; error < 1e-9 there.
+  constexpr double sine(double x)
+  {
+    while (x > Pi)
+    {
+      x -= 2 * Pi;
+    }
+    while (x < -Pi)
+    {
+      x += 2 * Pi;
+    }
+    if (x > Pi / 2)
+    {
+      x = Pi - x;
+    }
+    else if (x < -Pi / 2)
+    {
+      x = -Pi - x;
+    }
+
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n)
+    {
+      term *= -x * x / ((2 * n) * (2 * n + 1));
+      sum += term;
+    }
+    return sum;
+  }
+
+  constexpr double exponential(double x)
+  {
+    // exp(x) = exp(x / 2^k)^(2^k) keeps the series argument small.
+    int halvings = 0;
+    while (absolute(x) > 0.5)
+    {
+      x /= 2;
+      ++halvings;
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 16; ++n)
+    {
+      term *= x / n;
+      sum += term;
+    }
+    for (int i = 0; i < halvings; ++i)
+    {
+      sum *= sum;
+    }
+    return sum;
+  }
+
+  constexpr double logarithm(double x)
+  {
+    // ln(x) = 2 atanh((x - 1) / (x + 1)) after scaling x into [0.5, 2].
+    constexpr double Ln2 = 0.69314718055994530942;
+    int exponent = 0;
+    while (x > 2.0)
+    {
+      x /= 2;
+      ++exponent;
+    }
+    while (x < 0.5)
+    {
+      x *= 2;
+      --exponent;
+    }
+    double y = (x - 1) / (x + 1);
+    double term = y;
+    double sum = 0.0;
+    for (int n = 1; n < 40; n += 2)
+    {
+      sum += term / n;
+      term *= y * y;
+    }
+    return 2 * sum + exponent * Ln2;
+  }
+
+  constexpr double power(double base, double exponent)
+  {
+    return base <= 0.0 ? 0.0 : exponential(exponent * logarithm(base));
+  }
+
+  // --- generators ---------------------------------------------------------
+
+  constexpr Table<uint8_t, 256> makeGamma(double gamma)
+  {
+    Table<uint8_t, 256> table = {};
+    for (size_t i = 0; i < 256; ++i)
+    {
+      table.values[i] = roundToByte(255.0 * power(i / 255.0, gamma));
+    }
+    return table;
+  }
+
+  // One full period, 128 +/- 127, so sin8(0) is the midpoint.
+  constexpr Table<uint8_t, 256> makeSine()
+  {
+    Table<uint8_t, 256> table = {};
+    for (size_t i = 0; i < 256; ++i)
+    {
+      table.values[i] = roundToByte(128.0 + 127.0 * sine(2 * Pi * i / 256.0));
+    }
+    return table;
+  }
+
+  // Fully saturated hue wheel at half lightness, matching HslColor(h, 1, 0.5).
+  constexpr Table<Rgb8, 256> makeHueWheel()
+  {
+    Table<Rgb8, 256> table = {};
+    for (size_t i = 0; i < 256; ++i)
+    {
+      double h = i * 6.0 / 256.0;
+      int sector = static_cast<int>(h);
+      double rising = 255.0 * (h - sector);
+      double falling = 255.0 - rising;
+      double r = 0, g = 0, b = 0;
+      switch (sector)
+      {
+      case 0: r = 255; g = rising; break;
+      case 1: r = falling; g = 255; break;
+      case 2: g = 255; b = rising; break;
+      case 3: g = falling; b = 255; break;
+      case 4: r = rising; b = 255; break;
+      default: r = 255; b = falling; break;
+      }
+      table.values[i] = {roundToByte(r), roundToByte(g), roundToByte(b)};
+    }
+    return table;
+  }
+
+  // --- tables -------------------------------------------------------------
+
+  // Perceptual brightness curve used for the UI brightness slider (was x^2 in float).
+  inline constexpr Table<uint8_t, 256> Brightness = makeGamma(2.0);
+  // WS2812 output gamma for colours that should look linear to the eye.
+  inline constexpr Table<uint8_t, 256> Gamma = makeGamma(2.2);
+  inline constexpr Table<uint8_t, 256> Sine = makeSine();
+  inline constexpr Table<Rgb8, 256> HueWheel = makeHueWheel();
+
+  constexpr uint8_t sin8(uint8_t theta) { return Sine[theta]; }
+  constexpr uint8_t cos8(uint8_t theta) { return Sine[static_cast<uint8_t>(theta + 64)]; }
+
+  // --- compile-time accuracy checks ---------------------------------------
+
+  constexpr bool near(double a, double b, double tolerance) { return absolute(a - b) <= tolerance; }
+
+  constexpr bool mathIsAccurate()
+  {
+    return near(sine(Pi / 6), 0.5, 1e-9) && near(sine(-Pi / 2), -1.0, 1e-9) &&
+           near(exponential(1.0), 2.71828182845904523536, 1e-9) &&
+           near(logarithm(10.0), 2.30258509299404568402, 1e-9) &&
+           near(power(0.5, 2.2), 0.21763764082403103, 1e-9);
+  }
+
+  template <size_t N>
+  constexpr bool isMonotonic(const Table<uint8_t, N> &table)
+  {
+    for (size_t i = 1; i < N; ++i)
+    {
+      if (table[i] < table[i - 1])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Every entry within one step of the exact value (rounding only).
+  constexpr bool sineIsAccurate()
+  {
+    for (size_t i = 0; i < 256; ++i)
+    {
+      double s = (Sine[i] - 128.0) / 127.0;
+      double c = (Sine[(i + 64) % 256] - 128.0) / 127.0;
+      if (!near(s * s + c * c, 1.0, 2.0 / 127.0))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr bool hueWheelIsSaturated()
+  {
+    for (size_t i = 0; i < 256; ++i)
+    {
+      const Rgb8 &c = HueWheel[i];
+      uint8_t high = c.r > c.g ? (c.r > c.b ? c.r : c.b) : (c.g > c.b ? c.g : c.b);
+      uint8_t low = c.r < c.g ? (c.r < c.b ? c.r : c.b) : (c.g < c.b ? c.g : c.b);
+      if (high != 255 || low != 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static_assert(mathIsAccurate(), "constexpr math series out of tolerance");
+  static_assert(Brightness[0] == 0 && Brightness[255] == 255 && Brightness[128] == 64, "brightness curve");
+  static_assert(isMonotonic(Brightness) && isMonotonic(Gamma), "gamma tables must be monotonic");
+  static_assert(Gamma[0] == 0 && Gamma[255] == 255 && Gamma[128] == 56, "gamma 2.2 curve");
+  static_assert(Sine[0] == 128 && Sine[64] == 255 && Sine[128] == 128 && Sine[192] == 1, "sine extrema");
+  static_assert(sineIsAccurate(), "sine table out of tolerance");
+  static_assert(HueWheel[0].r == 255 && HueWheel[0].g == 0 && HueWheel[0].b == 0, "hue 0 is red");
+  static_assert(hueWheelIsSaturated(), "hue wheel must stay fully saturated");
+}
@@ -0,0 +1,19 @@
+/*
+ * Minimal OSC 1.0 message reader for control surfaces (TouchOSC, DJ software).
+ * - Reads the address and the first argument only; bundles are ignored.
+ * - Works in place on the received packet, no allocation.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct OscMessage
+{
+  const char *address = nullptr;
+  bool hasArgument = false;
+  float argument = 0.0f; // int32 ('i') and float32 ('f') arguments
+};
+
+bool parseOscMessage(const uint8_t *packet, size_t length, OscMessage &message);
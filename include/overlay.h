@@ -0,0 +1,53 @@
+/*
+ * Short-lived overlays (flash, wipe, pulse) drawn over the running effect.
+ * - The overlay never touches the effect's frame; presentFrame() blends it in
+ *   while packing, so the base effect keeps running underneath.
+ * - Per-frame state (alpha, wipe extent) is computed once in advance(); the
+ *   per-pixel cost is a compare and, where covered, one blend.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum class OverlayKind : uint8_t
+{
+  None,
+  Flash, // Full strip, fades out over the TTL
+  Wipe,  // Fills along the spiral over the TTL
+  Pulse  // Full strip, rises and falls once over the TTL
+};
+
+struct OverlayRequest
+{
+  OverlayKind kind = OverlayKind::None;
+  uint8_t r = 255;
+  uint8_t g = 255;
+  uint8_t b = 255;
+  uint16_t ttlMs = 250;
+};
+
+class Overlay
+{
+public:
+  static constexpr uint16_t MaxTtlMs = 10000;
+
+  void trigger(const OverlayRequest &request, uint32_t nowMs);
+
+  // Moves the overlay to `nowMs`. Returns true when the output must be
+  // re-sent: while the overlay is visible and once more after it ends.
+  bool advance(uint32_t nowMs, uint16_t logicalCount);
+
+  bool visible() const { return active && alpha != 0; }
+  uint8_t alphaFor(uint16_t logical) const { return logical < coverEnd ? alpha : 0; }
+  const OverlayRequest &request() const { return current; }
+
+private:
+  OverlayRequest current;
+  uint32_t startMs = 0;
+  bool active = false;
+  uint8_t alpha = 0;
+  uint16_t coverEnd = 0;
+};
+
+bool overlayKindFromName(const char *name, OverlayKind &kind);
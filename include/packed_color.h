@@ -0,0 +1,155 @@
+/*
+ * SWAR colour kernels on packed 0x00RRGGBB words.
+ * - Scale and blend put red and blue in the 16-bit lanes of 0x00FF00FF and
+ *   green in 0x0000FF00, so two multiplies cover three channels and no
+ *   product reaches the next lane.
+ * - Saturating add and max need no multiply: they work on all three bytes at
+ *   once, with carries and borrows kept out of the neighbouring byte.
+ * - packed::reference holds the per-channel versions; the static_asserts at
+ *   the bottom check each kernel against them on edge values at compile time,
+ *   and the simulator's "kernels" mode on every input (sim/kernel_bench.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace packed
+{
+  constexpr uint32_t RedBlue = 0x00FF00FF;
+  constexpr uint32_t Green = 0x0000FF00;
+  constexpr uint32_t High = 0x00808080; // Top bit of each channel
+  constexpr uint32_t Low = 0x007F7F7F;
+
+  constexpr uint32_t pack(uint8_t r, uint8_t g, uint8_t b)
+  {
+    return static_cast<uint32_t>(r) << 16 | static_cast<uint32_t>(g) << 8 | b;
+  }
+
+  constexpr uint8_t red(uint32_t color) { return static_cast<uint8_t>(color >> 16); }
+  constexpr uint8_t green(uint32_t color) { return static_cast<uint8_t>(color >> 8); }
+  constexpr uint8_t blue(uint32_t color) { return static_cast<uint8_t>(color); }
+
+  // channel * factor / 256, factor 0-256.
+  constexpr uint32_t scale(uint32_t color, uint16_t factor)
+  {
+    return ((((color & RedBlue) * factor) >> 8) & RedBlue) | ((((color & Green) * factor) >> 8) & Green);
+  }
+
+  // Same as RgbColor::Dim: channel * (level + 1) / 256.
+  constexpr uint32_t dim(uint32_t color, uint8_t level)
+  {
+    return scale(color, static_cast<uint16_t>(level + 1));
+  }
+
+  // from + (to - from) * (progress + 1) / 256, rounded down; 255 gives `to`.
+  constexpr uint32_t blend(uint32_t from, uint32_t to, uint8_t progress)
+  {
+    const uint32_t toWeight = progress + 1u;
+    const uint32_t fromWeight = 256u - toWeight;
+    return ((((from & RedBlue) * fromWeight + (to & RedBlue) * toWeight) >> 8) & RedBlue) |
+           ((((from & Green) * fromWeight + (to & Green) * toWeight) >> 8) & Green);
+  }
+
+  // Per channel min(a + b, 255). The low seven bits add without reaching the
+  // next byte; the top bit and its carry are worked out separately.
+  constexpr uint32_t add(uint32_t a, uint32_t b)
+  {
+    const uint32_t low = (a & Low) + (b & Low);
+    const uint32_t carry = ((a & b) | ((a | b) & low)) & High;
+    return (low ^ ((a ^ b) & High)) | ((carry >> 7) * 0xFF);
+  }
+
+  // Per channel max(a - b, 0). Each byte borrows from its own top bit.
+  constexpr uint32_t subtract(uint32_t a, uint32_t b)
+  {
+    const uint32_t difference = ((a | High) - (b & Low)) ^ ((a ^ ~b) & High);
+    const uint32_t borrow = ((~a & b) | (~(a ^ b) & difference)) & High;
+    return difference & ~((borrow >> 7) * 0xFF) & (RedBlue | Green);
+  }
+
+  constexpr uint32_t max(uint32_t a, uint32_t b)
+  {
+    return b + subtract(a, b); // Never carries: each channel ends at max(a, b)
+  }
+
+  namespace reference
+  {
+    constexpr uint8_t scale(uint8_t channel, uint16_t factor) { return static_cast<uint8_t>((channel * factor) >> 8); }
+    constexpr uint8_t blend(uint8_t from, uint8_t to, uint8_t progress)
+    {
+      return static_cast<uint8_t>((from * (255u - progress) + to * (progress + 1u)) >> 8);
+    }
+    constexpr uint8_t add(uint8_t a, uint8_t b) { return static_cast<uint8_t>(a + b > 255 ? 255 : a + b); }
+    constexpr uint8_t subtract(uint8_t a, uint8_t b) { return static_cast<uint8_t>(a > b ? a - b : 0); }
+    constexpr uint8_t max(uint8_t a, uint8_t b) { return a > b ? a : b; }
+  }
+
+  namespace check
+  {
+    constexpr uint8_t Values[] = {0, 1, 2, 63, 64, 127, 128, 129, 191, 254, 255};
+    constexpr uint16_t Factors[] = {0, 1, 2, 127, 128, 129, 255, 256};
+
+    // Every pair of edge values in every channel position.
+    template <typename Packed, typename Reference>
+    constexpr bool pairs(Packed kernel, Reference expected)
+    {
+      for (uint8_t a : Values)
+      {
+        for (uint8_t b : Values)
+        {
+          uint32_t result = kernel(pack(a, b, a), pack(b, a, b));
+          if (red(result) != expected(a, b) || green(result) != expected(b, a) || blue(result) != expected(a, b) ||
+              (result >> 24) != 0)
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    constexpr bool scaled()
+    {
+      for (uint8_t a : Values)
+      {
+        for (uint16_t factor : Factors)
+        {
+          uint32_t result = scale(pack(a, 255 - a, a), factor);
+          if (red(result) != reference::scale(a, factor) || green(result) != reference::scale(255 - a, factor) ||
+              blue(result) != reference::scale(a, factor))
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    constexpr bool blended()
+    {
+      for (uint16_t progress : Factors)
+      {
+        if (progress > 255)
+        {
+          continue;
+        }
+        auto kernel = [progress](uint32_t a, uint32_t b)
+        { return blend(a, b, static_cast<uint8_t>(progress)); };
+        auto expected = [progress](uint8_t a, uint8_t b)
+        { return reference::blend(a, b, static_cast<uint8_t>(progress)); };
+        if (!pairs(kernel, expected))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  static_assert(check::scaled(), "packed::scale must match reference::scale");
+  static_assert(check::blended(), "packed::blend must match reference::blend");
+  static_assert(check::pairs(add, reference::add), "packed::add must match reference::add");
+  static_assert(check::pairs(subtract, reference::subtract), "packed::subtract must match reference::subtract");
+  static_assert(check::pairs(max, reference::max), "packed::max must match reference::max");
+}
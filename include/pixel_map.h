@@ -0,0 +1,64 @@
+/*
+ * Logical-to-physical pixel mapping.
+ * - Effects render into a dense logical frame; the output pass looks up each
+ *   physical LED's source pixel in a precomputed table (one load per LED).
+ * - Wiring order, dead LEDs and the user mirror/reverse/offset transforms are
+ *   composed into that single table whenever the layout changes.
+ * - Effects may render fewer pixels than the strip has (grouping or a fixed
+ *   virtual length); the table then also carries the stretch back out, with an
+ *   optional blend weight towards the next pixel for smooth expansion.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "strip_config.h"
+
+// A stretch of physical LEDs, listed in the order they run along the spiral.
+struct PixelRun
+{
+  uint16_t start;
+  uint16_t length;
+  bool reversed;
+};
+
+struct PixelMapConfig
+{
+  const PixelRun *runs = nullptr; // nullptr means one forward run over the strip
+  uint8_t runCount = 0;
+  const uint16_t *deadPixels = nullptr; // Physical indices to skip
+  uint8_t deadCount = 0;
+  uint16_t activeCount = MaxPixelCount; // Physical LEDs at or beyond this stay dark
+  uint16_t offset = 0;                  // Rotates the logical start along the spiral
+  bool reverse = false;
+  bool mirror = false; // Second half of the spiral repeats the first, folded back
+  uint8_t group = 1;          // Physical LEDs per rendered pixel
+  uint16_t renderLength = 0;  // Fixed rendered length, overrides group when non-zero
+  bool interpolate = false;   // Blend between rendered pixels instead of repeating them
+};
+
+class PixelMap
+{
+public:
+  static constexpr uint16_t Unmapped = 0xFFFF;
+
+  void build(const PixelMapConfig &config);
+
+  // Number of logical pixels effects should render.
+  uint16_t logicalCount() const { return logicalPixels; }
+
+  // Logical source for a physical LED, or Unmapped if it must stay dark.
+  uint16_t sourceFor(uint16_t physical) const { return physicalToLogical[physical]; }
+
+  // Weight (0-255) of logical pixel sourceFor() + 1 in this LED; 0 means no blend.
+  uint8_t blendFor(uint16_t physical) const { return blendWeight[physical]; }
+
+  bool interpolates() const { return interpolating; }
+
+private:
+  uint16_t physicalToLogical[MaxPixelCount];
+  uint8_t blendWeight[MaxPixelCount];
+  uint16_t logicalPixels = 0;
+  bool interpolating = false;
+};
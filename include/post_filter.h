@@ -0,0 +1,97 @@
+/*
+ * Convolution post chain along the LED chain: blur, glow and sharpen.
+ * - A chain is up to three stages written like "blur5+glow3"; each stage is
+ *   a 3, 5 or 7 tap kernel built from a binomial blur, so a stage is one
+ *   fixed-point dot product per pixel (weights in 1/256, summing to >= 256).
+ * - glow adds the blurred light on top (halo), sharpen subtracts it (unsharp
+ *   mask); strength scales both.
+ * - Channels are copied into a line buffer padded with the edge pixels, so
+ *   the window slides across the strip with no edge tests in the inner loop.
+ * - On a partitioned canvas the padding holds the neighbours' pixels
+ *   (halos) instead, deep enough for every stage, so a slice filters exactly
+ *   as it would inside one long strip.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "strip_config.h"
+
+class PostChain
+{
+public:
+  static constexpr uint8_t MaxStages = 3;
+  static constexpr uint8_t MaxTaps = 7;
+  static constexpr uint8_t MaxSpecLength = 23;
+  static constexpr uint8_t HaloWidth = MaxStages * (MaxTaps / 2); // Pixels read past each end
+
+  // "off" or an empty spec clears the chain. False leaves it unchanged.
+  bool configure(const char *spec, uint8_t strength);
+  static bool valid(const char *spec);
+
+  bool active() const { return stageCount != 0; }
+  const char *spec() const { return text; }
+  uint8_t strength() const { return amount; }
+  uint8_t tapCount() const; // All stages together, for cost per tap
+
+  // Filters `count` pixels of `input` into `output`. Works on any colour
+  // with R, G and B byte members. Halos are the HaloWidth pixels just past
+  // each end, in strip order, as RGB bytes; without one the end pixel is
+  // repeated.
+  template <typename Color>
+  void apply(const Color *input, Color *output, uint16_t count, const uint8_t *leftHalo = nullptr,
+             const uint8_t *rightHalo = nullptr)
+  {
+    static constexpr uint8_t Color::*Channels[] = {&Color::R, &Color::G, &Color::B};
+    for (uint8_t channel = 0; channel < 3; ++channel)
+    {
+      uint8_t Color::*member = Channels[channel];
+      int16_t *line = lines[0] + HaloWidth;
+      for (uint16_t pixel = 0; pixel < count; ++pixel)
+      {
+        line[pixel] = input[pixel].*member;
+      }
+      for (uint8_t pixel = 0; pixel < HaloWidth; ++pixel)
+      {
+        if (leftHalo)
+        {
+          lines[0][pixel] = leftHalo[pixel * 3 + channel];
+        }
+        if (rightHalo)
+        {
+          line[count + pixel] = rightHalo[pixel * 3 + channel];
+        }
+      }
+      const int16_t *result = run(count, leftHalo != nullptr, rightHalo != nullptr);
+      for (uint16_t pixel = 0; pixel < count; ++pixel)
+      {
+        output[pixel].*member = static_cast<uint8_t>(result[pixel]);
+      }
+    }
+  }
+
+private:
+  enum class Kind : uint8_t
+  {
+    Blur,
+    Glow,
+    Sharpen
+  };
+
+  struct Stage
+  {
+    uint8_t taps;
+    int16_t weights[MaxTaps];
+  };
+
+  static bool parse(const char *spec, Kind *kinds, uint8_t *taps, uint8_t &count);
+  static void buildStage(Stage &stage, Kind kind, uint8_t taps, uint8_t strength);
+  const int16_t *run(uint16_t count, bool leftHalo, bool rightHalo);
+
+  Stage stages[MaxStages] = {};
+  uint8_t stageCount = 0;
+  uint8_t amount = 128;
+  char text[MaxSpecLength + 1] = "off";
+  int16_t lines[2][MaxPixelCount + 2 * HaloWidth] = {};
+};
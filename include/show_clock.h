@@ -0,0 +1,29 @@
+/*
+ * Show clock: milliseconds since a show started, independent of when this
+ * device booted. Several logos given the same position play in step.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class ShowClock
+{
+public:
+  // Sets the clock so that it reads `positionMs` at local time `nowMs`.
+  void start(uint32_t nowMs, uint32_t positionMs = 0)
+  {
+    originMs = nowMs - positionMs;
+    running = true;
+  }
+
+  void stop() { running = false; }
+
+  bool isRunning() const { return running; }
+
+  uint32_t position(uint32_t nowMs) const { return running ? nowMs - originMs : 0; }
+
+private:
+  uint32_t originMs = 0;
+  bool running = false;
+};
@@ -0,0 +1,65 @@
+/*
+ * Polar position of every logical pixel on the spiral.
+ * - Logical pixels are spread evenly by arc length along the spiral
+ *   described in strip_config.h; rebuilt whenever the logical count changes.
+ * - Angles are 16-bit turns (65536 = full circle), radii 0-255 of the outer
+ *   radius.
+ * - Pixels are also indexed by angle and by radius, so sweeps and rings find
+ *   the pixels crossing an edge by binary search instead of testing them all.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "strip_config.h"
+
+struct PolarPoint
+{
+  uint16_t angle;
+  uint8_t radius;
+};
+
+class SpiralGeometry
+{
+public:
+  void build(uint16_t logicalCount);
+
+  uint16_t count() const { return pointCount; }
+  const PolarPoint &point(uint16_t logical) const { return points[logical]; }
+
+  // Logical pixel at `rank` in ascending angle / radius order.
+  uint16_t byAngle(uint16_t rank) const { return angleOrder[rank]; }
+  uint16_t byRadius(uint16_t rank) const { return radiusOrder[rank]; }
+
+  // First rank whose angle / radius is >= value (count() if none).
+  uint16_t angleRank(uint16_t angle) const;
+  uint16_t radiusRank(uint8_t radius) const;
+
+  // Calls visit(logical) for each pixel with angle in [from, to), going
+  // forward round the circle; costs only the pixels inside the arc.
+  template <typename Visit>
+  void forEachInArc(uint16_t from, uint16_t to, Visit visit) const
+  {
+    uint16_t start = angleRank(from);
+    uint16_t end = angleRank(to);
+    if (from > to)
+    {
+      for (uint16_t rank = start; rank < pointCount; ++rank)
+      {
+        visit(angleOrder[rank]);
+      }
+      start = 0;
+    }
+    for (uint16_t rank = start; rank < end; ++rank)
+    {
+      visit(angleOrder[rank]);
+    }
+  }
+
+private:
+  PolarPoint points[MaxPixelCount] = {};
+  uint16_t angleOrder[MaxPixelCount] = {};
+  uint16_t radiusOrder[MaxPixelCount] = {};
+  uint16_t pointCount = 0;
+};
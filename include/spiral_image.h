@@ -0,0 +1,79 @@
+/*
+ * An uploaded image mapped onto the spiral.
+ * - The image is fitted into the spiral's circle. Each pixel's sample
+ *   position is precomputed from its polar position (bind()), so playback
+ *   is one bilinear gather per pixel with no trigonometry.
+ * - Scrolling adds a fixed-point offset to the precomputed x position, wrapping
+ *   round the image's width.
+ * - For rotation the image is resampled once into a polar texture (angle x
+ *   radius) at upload. Rotating is then an offset along the angle axis.
+ * - Pixels are raw RGB rows; everything lives in fixed buffers. Uploads
+ *   fill a second buffer, so the loaded image keeps playing until finish()
+ *   swaps the new one in.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lookup_tables.h"
+#include "spiral_geometry.h"
+
+class SpiralImage
+{
+public:
+  static constexpr uint8_t MaxSide = 64;
+  static constexpr uint16_t PolarAngles = 128;
+  static constexpr uint8_t PolarRadii = 24;
+
+  // Upload: begin(), then write() the RGB rows in any chunking, then
+  // finish() to take them over and build the polar texture. begin() and
+  // write() only touch the upload buffer; finish() must run on the task
+  // that samples.
+  bool begin(uint8_t width, uint8_t height);
+  bool write(size_t offset, const uint8_t *data, size_t length);
+  bool finish();
+  uint8_t uploadWidth() const { return stagedWidth; }
+  uint8_t uploadHeight() const { return stagedHeight; }
+  size_t uploadByteCount() const { return static_cast<size_t>(stagedWidth) * stagedHeight * 3; }
+
+  // Recomputes per-pixel sample positions; call when the geometry changes.
+  void bind(const SpiralGeometry &geometry);
+
+  bool loaded() const { return ready; }
+  uint8_t width() const { return imageWidth; }
+  uint8_t height() const { return imageHeight; }
+  size_t byteCount() const { return static_cast<size_t>(imageWidth) * imageHeight * 3; }
+  const uint8_t *bytes() const { return pixels; }
+
+  // scroll: horizontal offset in 1/256 texels. rotation: 1/65536 turns.
+  lut::Rgb8 sampleScrolled(uint16_t logical, uint32_t scroll) const;
+  lut::Rgb8 sampleRotated(uint16_t logical, uint16_t rotation) const;
+
+private:
+  // Sample positions in 8.8 fixed point, texels / polar bins.
+  struct Tap
+  {
+    uint16_t x;
+    uint16_t y;
+    uint16_t angle;
+    uint16_t radius;
+  };
+
+  lut::Rgb8 texel(uint8_t x, uint8_t y) const;
+  lut::Rgb8 sampleImage(float x, float y) const;
+  void placeTaps();
+
+  uint8_t pixels[MaxSide * MaxSide * 3] = {};
+  uint8_t staged[MaxSide * MaxSide * 3] = {};
+  lut::Rgb8 polar[PolarRadii][PolarAngles] = {};
+  Tap taps[MaxPixelCount] = {};
+  PolarPoint positions[MaxPixelCount] = {};
+  uint16_t tapCount = 0;
+  uint8_t imageWidth = 0;
+  uint8_t imageHeight = 0;
+  uint8_t stagedWidth = 0;
+  uint8_t stagedHeight = 0;
+  volatile bool ready = false;
+};
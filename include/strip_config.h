@@ -0,0 +1,24 @@
+/*
+ * Hardware description of the LED strip on the spiral logo.
+ * - Everything here is a fact about the physical build, not a user setting.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+constexpr uint16_t MaxPixelCount = 144; // Common LED strip size
+constexpr uint8_t PixelPin = 12;
+
+// White balance of the WS2812B strip behind the diffuser, per channel at full
+// drive. Typical 5050 LEDs run blue- and green-heavy; measured by eye against
+// a 5000 K reference.
+constexpr uint8_t CalibrationRed = 255;
+constexpr uint8_t CalibrationGreen = 176;
+constexpr uint8_t CalibrationBlue = 240;
+
+// Shape of the spiral the strip is glued along: an Archimedean spiral from
+// the first LED at the centre outwards. The inner radius is in 1/255ths of
+// the outer one.
+constexpr uint8_t SpiralTurns = 4;
+constexpr uint8_t SpiralInnerRadius = 40;
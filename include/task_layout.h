@@ -0,0 +1,82 @@
+/*
+ * Core placement and priority profiles for the firmware's tasks.
+ * - Render is pinned to core 1 (next to the idle Arduino loop, which only
+ *   logs); async_tcp shares core 0 with the WiFi stack, fixed at build
+ *   time (CONFIG_ASYNC_TCP_RUNNING_CORE).
+ * - Render's frame jitter depends only on what else runs on core 1, so a
+ *   profile decides where the UDP receivers go: core 1 below render, core
+ *   0 next to async_tcp, or core 1 above render. Profiles can be switched
+ *   at runtime to compare frame jitter; the udp task moves itself.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+enum class TaskProfile : uint8_t
+{
+  Balanced,
+  RenderFirst,
+  NetworkFirst,
+  Count
+};
+
+struct TaskPlacement
+{
+  uint8_t renderPriority;
+  uint8_t networkCore; // UDP receivers
+  uint8_t networkPriority;
+  uint8_t asyncTcpPriority;
+};
+
+namespace tasks
+{
+  constexpr uint8_t RenderCore = 1;
+  constexpr uint8_t AsyncTcpCore = 0; // CONFIG_ASYNC_TCP_RUNNING_CORE in platformio.ini
+  constexpr uint32_t RenderStackSize = 6144;
+  constexpr uint32_t NetworkStackSize = 4096;
+
+  // Indexed by TaskProfile. async_tcp keeps its default priority, 3.
+  constexpr TaskPlacement Profiles[] = {
+      // balanced: UDP input runs in render's idle time on core 1, clear of
+      // WiFi and HTTP; a frame preempts it, so it waits at most one frame.
+      {4, 1, 2, 3},
+      // render-first: core 1 runs nothing but render; UDP input takes turns
+      // with HTTP on core 0.
+      {4, 0, 3, 3},
+      // network-first: UDP input on core 1 preempts render; lowest input
+      // latency, frames start late while it polls.
+      {3, 1, 5, 3},
+  };
+
+  constexpr const char *Names[] = {"balanced", "render-first", "network-first"};
+
+  static_assert(sizeof(Profiles) / sizeof(Profiles[0]) == static_cast<size_t>(TaskProfile::Count),
+                "one placement per TaskProfile");
+  static_assert(sizeof(Names) / sizeof(Names[0]) == static_cast<size_t>(TaskProfile::Count),
+                "one name per TaskProfile");
+
+  inline const TaskPlacement &placement(TaskProfile profile)
+  {
+    return Profiles[static_cast<size_t>(profile)];
+  }
+
+  inline const char *name(TaskProfile profile)
+  {
+    return Names[static_cast<size_t>(profile)];
+  }
+
+  inline bool fromName(const char *value, TaskProfile &profile)
+  {
+    for (uint8_t index = 0; index < static_cast<uint8_t>(TaskProfile::Count); ++index)
+    {
+      if (strcmp(value, Names[index]) == 0)
+      {
+        profile = static_cast<TaskProfile>(index);
+        return true;
+      }
+    }
+    return false;
+  }
+}
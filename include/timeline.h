@@ -0,0 +1,77 @@
+/*
+ * Keyframe timelines for choreographed shows.
+ * - A timeline is a set of per-parameter tracks; each track is a sorted list
+ *   of keyframes. All of it is const data, so built-in shows live in flash.
+ * - The player keeps one cursor per track. Playing forward only ever moves a
+ *   cursor by the keyframes passed since the last frame, so evaluation is
+ *   O(1) per track per frame; seeking backwards rewinds the cursor once.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "easing.h"
+
+enum class TimelineParam : uint8_t
+{
+  Brightness,
+  Red,
+  Green,
+  Blue,
+  Count
+};
+
+// Curve used from a keyframe to the next one. Step holds the value until the
+// next keyframe; everything else is an easing curve between the two values.
+enum class KeyCurve : uint8_t
+{
+  Step = 0xFF
+};
+
+struct Keyframe
+{
+  uint32_t timeMs;
+  uint8_t value;
+  uint8_t curve; // static_cast<uint8_t>(Easing) or KeyCurve::Step
+};
+
+struct TimelineTrack
+{
+  TimelineParam param;
+  uint8_t keyCount;
+  const Keyframe *keys;
+};
+
+struct Timeline
+{
+  const char *name;
+  uint32_t durationMs;
+  bool loop; // Otherwise the last keyframes hold after durationMs
+  uint8_t trackCount;
+  const TimelineTrack *tracks;
+};
+
+constexpr uint8_t curveOf(Easing easing) { return static_cast<uint8_t>(easing); }
+constexpr uint8_t curveOf(KeyCurve curve) { return static_cast<uint8_t>(curve); }
+
+class TimelinePlayer
+{
+public:
+  static constexpr uint8_t MaxTracks = 8;
+
+  void load(const Timeline *timeline);
+  const Timeline *current() const { return timeline; }
+
+  // Evaluates every track at `positionMs` into `values` (indexed by
+  // TimelineParam). Parameters without a track are left untouched.
+  void evaluate(uint32_t positionMs, uint8_t values[static_cast<uint8_t>(TimelineParam::Count)]);
+
+private:
+  const Timeline *timeline = nullptr;
+  uint8_t cursors[MaxTracks] = {};
+  uint32_t lastPositionMs = 0;
+};
+
+extern const Timeline *const BuiltInShows[];
+extern const uint8_t BuiltInShowCount;
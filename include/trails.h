@@ -0,0 +1,37 @@
+/*
+ * Motion trails as a post effect over any effect's frame.
+ * - A history frame keeps the last output; each present folds the new frame
+ *   into it, channel by channel: max(new, old * decay / 256).
+ * - The max (rather than a sum) keeps solid areas at their own colour while
+ *   moving parts leave a tail that shrinks by the same factor every frame.
+ * - One multiply and one compare per channel, over the logical pixels only.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace trails
+{
+  // decay: 0 drops the trail at once, 255 keeps it longest (~4 s at 60 fps).
+  // Works on any colour with R, G and B byte members. Returns true while
+  // the history still differs from `frame`, i.e. a trail is fading.
+  template <typename Color>
+  bool fold(const Color *frame, Color *history, uint16_t count, uint8_t decay)
+  {
+    bool fading = false;
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
+    {
+      const Color &fresh = frame[pixel];
+      Color &out = history[pixel];
+      uint8_t r = static_cast<uint8_t>((out.R * decay) >> 8);
+      uint8_t g = static_cast<uint8_t>((out.G * decay) >> 8);
+      uint8_t b = static_cast<uint8_t>((out.B * decay) >> 8);
+      out.R = r > fresh.R ? r : fresh.R;
+      out.G = g > fresh.G ? g : fresh.G;
+      out.B = b > fresh.B ? b : fresh.B;
+      fading |= r > fresh.R || g > fresh.G || b > fresh.B;
+    }
+    return fading;
+  }
+}
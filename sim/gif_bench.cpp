@@ -0,0 +1,313 @@
+/*
+ * GIF decode time at common canvas sizes, as the render task pays it.
+ * - GIFs are encoded here: 8 frames of 64x64 to 512x512 with a 256-colour
+ *   palette, every other frame interlaced. "gradient" compresses like
+ *   artwork; "noise" is random indices, the worst case for LZW.
+ * - Each frame is decoded from memory onto the spiral's sample points, so
+ *   SPIFFS reads are not included; on the device they come on top.
+ * - First, flat frames (one palette index each) are decoded through two
+ *   loops and every sample checked, so a decode error fails the run.
+ *
+ *   .pio/build/native/program gif
+ */
+
+#include "gif_bench.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+#include "gif_player.h"
+#include "spiral_geometry.h"
+#include "strip_config.h"
+
+namespace
+{
+  constexpr double MinSeconds = 0.2; // Per GIF
+  constexpr uint8_t FrameCount = 8;
+  constexpr uint16_t DelayCs = 5; // 50 ms frames
+  constexpr uint32_t FrameBudgetUs = 16000;
+  const uint16_t Sides[] = {64, 128, 256, 512};
+
+  enum class Content
+  {
+    Flat,
+    Gradient,
+    Noise
+  };
+
+  const char *const ContentNames[] = {"flat", "gradient", "noise"};
+
+  class MemoryReader : public GifReader
+  {
+  public:
+    explicit MemoryReader(const std::vector<uint8_t> &bytes) : bytes(bytes) {}
+
+    size_t read(uint8_t *buffer, size_t length) override
+    {
+      size_t count = bytes.size() - position < length ? bytes.size() - position : length;
+      memcpy(buffer, bytes.data() + position, count);
+      position += count;
+      return count;
+    }
+
+    bool seek(uint32_t to) override
+    {
+      position = to;
+      return to <= bytes.size();
+    }
+
+  private:
+    const std::vector<uint8_t> &bytes;
+    size_t position = 0;
+  };
+
+  lut::Rgb8 paletteColor(uint8_t index)
+  {
+    return {index, static_cast<uint8_t>(index * 7), static_cast<uint8_t>(255 - index)};
+  }
+
+  void putShort(std::vector<uint8_t> &out, uint16_t value)
+  {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+  }
+
+  // Variable-width LZW with 8-bit roots, clearing when the table is full,
+  // packed LSB first into data sub-blocks.
+  void encodeImage(std::vector<uint8_t> &out, const std::vector<uint8_t> &indices)
+  {
+    constexpr uint16_t Clear = 256;
+    constexpr uint16_t End = 257;
+    std::vector<uint8_t> packed;
+    uint32_t bits = 0;
+    uint8_t bitCount = 0;
+    uint8_t size = 9;
+    auto emit = [&](uint16_t code)
+    {
+      bits |= static_cast<uint32_t>(code) << bitCount;
+      bitCount += size;
+      while (bitCount >= 8)
+      {
+        packed.push_back(static_cast<uint8_t>(bits));
+        bits >>= 8;
+        bitCount -= 8;
+      }
+    };
+
+    std::unordered_map<uint32_t, uint16_t> table;
+    uint16_t next = End + 1;
+    emit(Clear);
+    int32_t prefix = -1;
+    for (uint8_t index : indices)
+    {
+      if (prefix < 0)
+      {
+        prefix = index;
+        continue;
+      }
+      uint32_t key = static_cast<uint32_t>(prefix) << 8 | index;
+      auto found = table.find(key);
+      if (found != table.end())
+      {
+        prefix = found->second;
+        continue;
+      }
+
+      emit(static_cast<uint16_t>(prefix));
+      if (next < GifPlayer::MaxCodes)
+      {
+        table[key] = next++;
+      }
+      else
+      {
+        emit(Clear);
+        table.clear();
+        next = End + 1;
+        size = 9;
+      }
+      // The decoder widens one entry later than it adds, so this matches it.
+      if (next - 1 == (1 << size) && size < 12)
+      {
+        ++size;
+      }
+      prefix = index;
+    }
+    emit(static_cast<uint16_t>(prefix));
+    emit(End);
+    if (bitCount)
+    {
+      packed.push_back(static_cast<uint8_t>(bits));
+    }
+
+    out.push_back(8);
+    for (size_t offset = 0; offset < packed.size(); offset += 255)
+    {
+      size_t length = packed.size() - offset < 255 ? packed.size() - offset : 255;
+      out.push_back(static_cast<uint8_t>(length));
+      out.insert(out.end(), packed.begin() + offset, packed.begin() + offset + length);
+    }
+    out.push_back(0);
+  }
+
+  uint8_t pixelIndex(Content content, uint16_t x, uint16_t y, uint8_t frame, uint32_t &random)
+  {
+    switch (content)
+    {
+    case Content::Flat:
+      return static_cast<uint8_t>(frame * 31 + 7);
+    case Content::Gradient:
+      return static_cast<uint8_t>(x * 3 + y * 5 + frame * 17);
+    case Content::Noise:
+      break;
+    }
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return static_cast<uint8_t>(random);
+  }
+
+  std::vector<uint8_t> encodeGif(uint16_t side, Content content)
+  {
+    std::vector<uint8_t> out = {'G', 'I', 'F', '8', '9', 'a'};
+    putShort(out, side);
+    putShort(out, side);
+    out.insert(out.end(), {0xF7, 0, 0}); // Global palette of 256
+    for (uint16_t index = 0; index < 256; ++index)
+    {
+      lut::Rgb8 color = paletteColor(static_cast<uint8_t>(index));
+      out.insert(out.end(), {color.r, color.g, color.b});
+    }
+
+    uint32_t random = 0x9E3779B9u;
+    std::vector<uint8_t> indices(static_cast<size_t>(side) * side);
+    for (uint8_t frame = 0; frame < FrameCount; ++frame)
+    {
+      bool interlaced = frame % 2;
+      std::vector<uint16_t> rows;
+      for (uint8_t pass = 0; pass < (interlaced ? 4 : 1); ++pass)
+      {
+        static const uint8_t Start[] = {0, 4, 2, 1};
+        static const uint8_t Step[] = {8, 8, 4, 2};
+        for (uint16_t y = interlaced ? Start[pass] : 0; y < side; y += interlaced ? Step[pass] : 1)
+        {
+          rows.push_back(y);
+        }
+      }
+      size_t at = 0;
+      for (uint16_t y : rows)
+      {
+        for (uint16_t x = 0; x < side; ++x)
+        {
+          indices[at++] = pixelIndex(content, x, y, frame, random);
+        }
+      }
+
+      out.insert(out.end(), {0x21, 0xF9, 4, 0});
+      putShort(out, DelayCs);
+      out.insert(out.end(), {0, 0, 0x2C});
+      putShort(out, 0);
+      putShort(out, 0);
+      putShort(out, side);
+      putShort(out, side);
+      out.push_back(interlaced ? 0x40 : 0);
+      encodeImage(out, indices);
+    }
+    out.push_back(0x3B);
+    return out;
+  }
+
+  // Two loops of flat frames: every sample must be that frame's colour.
+  bool checkFlat(GifPlayer &player, uint16_t side)
+  {
+    std::vector<uint8_t> bytes = encodeGif(side, Content::Flat);
+    MemoryReader reader(bytes);
+    if (!player.open(reader))
+    {
+      return false;
+    }
+    for (uint8_t decoded = 0; decoded < 2 * FrameCount; ++decoded)
+    {
+      if (!player.decodeFrame() || player.frameDelayMs() != DelayCs * 10)
+      {
+        return false;
+      }
+      lut::Rgb8 expected = paletteColor(static_cast<uint8_t>(decoded % FrameCount * 31 + 7));
+      for (uint16_t pixel = 0; pixel < MaxPixelCount; ++pixel)
+      {
+        lut::Rgb8 color = player.sample(pixel);
+        if (color.r != expected.r || color.g != expected.g || color.b != expected.b)
+        {
+          return false;
+        }
+      }
+    }
+    player.close();
+    return true;
+  }
+}
+
+int runGifBench(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  static SpiralGeometry geometry;
+  static GifPlayer player;
+  geometry.build(MaxPixelCount);
+  player.bind(geometry);
+
+  bool ok = true;
+  printf("GIF decode onto %u pixels, %u frames per GIF, every other one interlaced\n", MaxPixelCount, FrameCount);
+  for (uint16_t side : Sides)
+  {
+    if (!checkFlat(player, side))
+    {
+      printf("  %3ux%-3u flat frames: FAILED\n", side, side);
+      ok = false;
+    }
+  }
+
+  for (uint8_t content = static_cast<uint8_t>(Content::Gradient); content <= static_cast<uint8_t>(Content::Noise);
+       ++content)
+  {
+    for (uint16_t side : Sides)
+    {
+      std::vector<uint8_t> bytes = encodeGif(side, static_cast<Content>(content));
+      MemoryReader reader(bytes);
+      if (!player.open(reader))
+      {
+        printf("  %3ux%-3u %-8s: FAILED to open\n", side, side, ContentNames[content]);
+        ok = false;
+        continue;
+      }
+
+      uint32_t frames = 0;
+      double seconds = 0;
+      bool decoded = true;
+      auto start = std::chrono::steady_clock::now();
+      while (decoded && seconds < MinSeconds)
+      {
+        decoded = player.decodeFrame();
+        ++frames;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      player.close();
+      if (!decoded)
+      {
+        printf("  %3ux%-3u %-8s: FAILED at frame %u\n", side, side, ContentNames[content], frames - 1);
+        ok = false;
+        continue;
+      }
+      double us = seconds * 1e6 / frames;
+      printf("  %3ux%-3u %-8s %7zu-byte file: %8.1f us/frame (%4.1f%% of the %u ms frame)\n", side, side,
+             ContentNames[content], bytes.size(), us, us * 100 / FrameBudgetUs, FrameBudgetUs / 1000);
+    }
+  }
+  return ok ? 0 : 1;
+}
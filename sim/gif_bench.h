@@ -0,0 +1,10 @@
+/*
+ * GIF decode benchmark mode of the native simulator: generated GIFs at
+ * common canvas sizes through the streaming decoder, checked and timed.
+ * See gif_bench.cpp.
+ */
+
+#pragma once
+
+// argv[0] is "gif"; returns the process exit code.
+int runGifBench(int argc, char **argv);
@@ -0,0 +1,193 @@
+/*
+ * Streaming JSON parser throughput on the bodies /api/control takes.
+ * - Payloads: a small control update, a whole state saved from /api/state
+ *   and a bank of 16 presets (states with a name and keys the firmware
+ *   doesn't know, some longer than MaxKeyLength).
+ * - Each is fed in 1436-byte chunks, one TCP segment as AsyncWebServer
+ *   hands it over, and in 64-byte chunks.
+ * - Every pass maps the values onto a typed struct like the firmware's
+ *   handler does and checks it, so a parse error fails the run.
+ *
+ *   .pio/build/native/program json
+ */
+
+#include "json_bench.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "json_stream.h"
+
+namespace
+{
+  constexpr double MinSeconds = 0.2; // Per payload and chunk size
+  const size_t ChunkSizes[] = {1436, 64};
+  constexpr uint8_t PresetCount = 16;
+
+  // As writeState() emits it: compact, 26 keys.
+  const char *const StateBody =
+      "{\"mode\":\"fade\",\"brightness\":160,\"easing\":\"in-out-sine\",\"color\":{\"r\":255,\"g\":80,\"b\":10},"
+      "\"count\":144,\"kelvin\":2700,\"bpm\":0.00,\"beatSync\":false,\"seed\":1234,\"show\":\"sunrise\","
+      "\"showTime\":0,\"overlayLatencyUs\":0,\"offset\":0,\"reverse\":false,\"mirror\":false,\"group\":1,"
+      "\"length\":0,\"smooth\":false,\"trails\":0,\"post\":\"off\",\"postStrength\":128,\"node\":0,\"nodes\":1,"
+      "\"slack\":92,\"rejected\":0,\"ip\":\"192.168.1.100\"}";
+
+  const char *const ControlBody = "{\"mode\":\"solid\",\"brightness\":200,\"r\":255,\"g\":0,\"b\":128}";
+
+  struct Settings
+  {
+    int32_t brightness = -1;
+    int32_t red = -1;
+    int32_t green = -1;
+    int32_t blue = -1;
+    char mode[16] = "";
+    uint32_t values = 0;
+  };
+
+  // Flat names and the nested "color" object alike, as ControlJsonHandler
+  // takes them.
+  class SettingsHandler : public JsonHandler
+  {
+  public:
+    Settings settings;
+
+    void onValue(const JsonStreamParser &parser, const JsonValue &value) override
+    {
+      ++settings.values;
+      uint8_t depth = parser.depth();
+      const char *name = depth ? parser.key(depth - 1) : "";
+
+      if (strcmp(name, "mode") == 0 && value.type == JsonType::String && value.length < sizeof(settings.mode))
+      {
+        memcpy(settings.mode, value.text, value.length + 1);
+      }
+      else if (strcmp(name, "brightness") == 0)
+      {
+        settings.brightness = value.integer;
+      }
+      else if (strcmp(name, "r") == 0)
+      {
+        settings.red = value.integer;
+      }
+      else if (strcmp(name, "g") == 0)
+      {
+        settings.green = value.integer;
+      }
+      else if (strcmp(name, "b") == 0)
+      {
+        settings.blue = value.integer;
+      }
+    }
+  };
+
+  struct Payload
+  {
+    const char *name;
+    std::string body;
+    Settings expected; // values is the number of scalars
+  };
+
+  Settings expect(const char *mode, int32_t brightness, int32_t red, int32_t green, int32_t blue, uint32_t values)
+  {
+    Settings settings;
+    strcpy(settings.mode, mode);
+    settings.brightness = brightness;
+    settings.red = red;
+    settings.green = green;
+    settings.blue = blue;
+    settings.values = values;
+    return settings;
+  }
+
+  std::string presetBank()
+  {
+    std::string body = "{\"version\":1,\"presets\":[";
+    for (uint8_t preset = 0; preset < PresetCount; ++preset)
+    {
+      char head[96];
+      snprintf(head, sizeof(head), "{\"name\":\"preset-%02u\",\"transitionDurationMs\":1500,\"segmentOffsets\":[0,48,96],",
+               preset);
+      body += preset ? "," : "";
+      body += head;
+      body += StateBody + 1; // The state's own keys, after its opening brace
+    }
+    return body + "]}";
+  }
+
+  bool parse(JsonStreamParser &parser, SettingsHandler &handler, const std::string &body, size_t chunk)
+  {
+    handler.settings = Settings();
+    parser.reset();
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(body.data());
+    for (size_t offset = 0; offset < body.size(); offset += chunk)
+    {
+      size_t length = body.size() - offset < chunk ? body.size() - offset : chunk;
+      if (parser.feed(data + offset, length) == JsonStreamParser::Status::Error)
+      {
+        return false;
+      }
+    }
+    return parser.finish() == JsonStreamParser::Status::Done;
+  }
+
+  bool matches(const Settings &actual, const Settings &expected)
+  {
+    return actual.brightness == expected.brightness && actual.red == expected.red &&
+           actual.green == expected.green && actual.blue == expected.blue &&
+           strcmp(actual.mode, expected.mode) == 0 && actual.values == expected.values;
+  }
+}
+
+int runJsonBench(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  // State: 28 scalars (the colour holds three); a preset adds its name,
+  // the transition and three offsets.
+  const Payload payloads[] = {
+      {"control", ControlBody, expect("solid", 200, 255, 0, 128, 5)},
+      {"state", StateBody, expect("fade", 160, 255, 80, 10, 28)},
+      {"presets", presetBank(), expect("fade", 160, 255, 80, 10, 1 + PresetCount * (28 + 5))},
+  };
+
+  SettingsHandler handler;
+  JsonStreamParser parser(handler);
+  bool ok = true;
+  printf("streaming JSON parser, %zu bytes of state\n", sizeof(JsonStreamParser));
+  for (const Payload &payload : payloads)
+  {
+    for (size_t chunk : ChunkSizes)
+    {
+      if (!parse(parser, handler, payload.body, chunk) || !matches(handler.settings, payload.expected))
+      {
+        printf("  %-8s %5zu bytes, %4zu-byte chunks: FAILED at offset %zu\n", payload.name, payload.body.size(),
+               chunk, parser.errorOffset());
+        ok = false;
+        continue;
+      }
+
+      uint32_t passes = 0;
+      double seconds = 0;
+      auto start = std::chrono::steady_clock::now();
+      while (seconds < MinSeconds)
+      {
+        for (uint8_t batch = 0; batch < 64; ++batch)
+        {
+          parse(parser, handler, payload.body, chunk);
+        }
+        passes += 64;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      double bytes = static_cast<double>(payload.body.size()) * passes;
+      printf("  %-8s %5zu bytes, %4zu-byte chunks: %7.1f MB/s, %8.2f us/body\n", payload.name, payload.body.size(),
+             chunk, bytes / seconds / 1e6, seconds / passes * 1e6);
+    }
+  }
+  return ok ? 0 : 1;
+}
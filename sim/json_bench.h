@@ -0,0 +1,10 @@
+/*
+ * JSON parser benchmark mode of the native simulator: realistic request
+ * bodies through the streaming parser, in TCP-sized and small chunks.
+ * See json_bench.cpp.
+ */
+
+#pragma once
+
+// argv[0] is "json"; returns the process exit code.
+int runJsonBench(int argc, char **argv);
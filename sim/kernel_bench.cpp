@@ -0,0 +1,209 @@
+/*
+ * The packed_color.h kernels against packed::reference, exhaustively.
+ * - Binary kernels get every pair of channel values, blend every pair at
+ *   every progress and scale every value at every factor, with each value
+ *   in all three channel positions at once. Any mismatch fails the run.
+ * - Then scale, blend and add over 144-pixel frames, per channel and
+ *   packed, with frames stored as RGB bytes (packing included, as the
+ *   firmware's RgbColor frames would need) and as packed words.
+ *
+ *   .pio/build/native/program kernels
+ */
+
+#include "kernel_bench.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#include "packed_color.h"
+#include "strip_config.h"
+
+namespace
+{
+  constexpr uint32_t BenchFrames = 200000;
+
+  // Red and blue see (a, b), green (b, a), so every position meets every
+  // ordered pair across the loop.
+  template <typename Packed, typename Reference>
+  uint64_t checkPairs(Packed kernel, Reference expected)
+  {
+    uint64_t mismatches = 0;
+    for (uint32_t a = 0; a < 256; ++a)
+    {
+      for (uint32_t b = 0; b < 256; ++b)
+      {
+        uint32_t result = kernel(packed::pack(a, b, a), packed::pack(b, a, b));
+        mismatches += packed::red(result) != expected(a, b) || packed::green(result) != expected(b, a) ||
+                      packed::blue(result) != expected(a, b) || (result >> 24) != 0;
+      }
+    }
+    return mismatches;
+  }
+
+  uint64_t checkScale()
+  {
+    uint64_t mismatches = 0;
+    for (uint32_t value = 0; value < 256; ++value)
+    {
+      for (uint32_t factor = 0; factor <= 256; ++factor)
+      {
+        uint8_t other = static_cast<uint8_t>(255 - value);
+        uint32_t result = packed::scale(packed::pack(value, other, value), static_cast<uint16_t>(factor));
+        mismatches += packed::red(result) != packed::reference::scale(value, factor) ||
+                      packed::green(result) != packed::reference::scale(other, factor) ||
+                      packed::blue(result) != packed::reference::scale(value, factor) || (result >> 24) != 0;
+      }
+    }
+    return mismatches;
+  }
+
+  uint64_t checkBlend()
+  {
+    uint64_t mismatches = 0;
+    for (uint32_t progress = 0; progress < 256; ++progress)
+    {
+      mismatches += checkPairs([progress](uint32_t a, uint32_t b)
+                               { return packed::blend(a, b, static_cast<uint8_t>(progress)); },
+                               [progress](uint8_t a, uint8_t b)
+                               { return packed::reference::blend(a, b, static_cast<uint8_t>(progress)); });
+    }
+    return mismatches;
+  }
+
+  struct Frames
+  {
+    uint8_t rgbA[MaxPixelCount * 3];
+    uint8_t rgbB[MaxPixelCount * 3];
+    uint8_t rgbOut[MaxPixelCount * 3];
+    uint32_t wordA[MaxPixelCount];
+    uint32_t wordB[MaxPixelCount];
+    uint32_t wordOut[MaxPixelCount];
+  };
+
+  // Op(a, b, k) per channel on bytes; PackedOp(a, b, k) on words.
+  template <typename Op>
+  __attribute__((noinline)) void rgbChannels(Frames &frames, uint8_t k, Op op)
+  {
+    for (uint16_t index = 0; index < MaxPixelCount * 3; ++index)
+    {
+      frames.rgbOut[index] = op(frames.rgbA[index], frames.rgbB[index], k);
+    }
+  }
+
+  template <typename PackedOp>
+  __attribute__((noinline)) void rgbPacked(Frames &frames, uint8_t k, PackedOp op)
+  {
+    for (uint16_t pixel = 0; pixel < MaxPixelCount; ++pixel)
+    {
+      const uint8_t *a = frames.rgbA + pixel * 3;
+      const uint8_t *b = frames.rgbB + pixel * 3;
+      uint32_t result = op(packed::pack(a[0], a[1], a[2]), packed::pack(b[0], b[1], b[2]), k);
+      uint8_t *out = frames.rgbOut + pixel * 3;
+      out[0] = packed::red(result);
+      out[1] = packed::green(result);
+      out[2] = packed::blue(result);
+    }
+  }
+
+  template <typename Op>
+  __attribute__((noinline)) void wordChannels(Frames &frames, uint8_t k, Op op)
+  {
+    for (uint16_t pixel = 0; pixel < MaxPixelCount; ++pixel)
+    {
+      uint32_t a = frames.wordA[pixel];
+      uint32_t b = frames.wordB[pixel];
+      frames.wordOut[pixel] = packed::pack(op(packed::red(a), packed::red(b), k), op(packed::green(a), packed::green(b), k),
+                                           op(packed::blue(a), packed::blue(b), k));
+    }
+  }
+
+  template <typename PackedOp>
+  __attribute__((noinline)) void wordPacked(Frames &frames, uint8_t k, PackedOp op)
+  {
+    for (uint16_t pixel = 0; pixel < MaxPixelCount; ++pixel)
+    {
+      frames.wordOut[pixel] = op(frames.wordA[pixel], frames.wordB[pixel], k);
+    }
+  }
+
+  template <typename Pass>
+  double nsPerPixel(Frames &frames, Pass pass)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < BenchFrames; ++frame)
+    {
+      pass(frames, static_cast<uint8_t>(frame));
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / BenchFrames / MaxPixelCount;
+  }
+
+  template <typename Op, typename PackedOp>
+  void bench(Frames &frames, const char *name, Op op, PackedOp packedOp)
+  {
+    double rgbRef = nsPerPixel(frames, [op](Frames &f, uint8_t k)
+                               { rgbChannels(f, k, op); });
+    double rgbSwar = nsPerPixel(frames, [packedOp](Frames &f, uint8_t k)
+                                { rgbPacked(f, k, packedOp); });
+    double wordRef = nsPerPixel(frames, [op](Frames &f, uint8_t k)
+                                { wordChannels(f, k, op); });
+    double wordSwar = nsPerPixel(frames, [packedOp](Frames &f, uint8_t k)
+                                 { wordPacked(f, k, packedOp); });
+    printf("  %-6s RGB bytes %5.2f -> %5.2f ns/pixel (%4.2fx), packed words %5.2f -> %5.2f ns/pixel (%4.2fx)\n", name,
+           rgbRef, rgbSwar, rgbRef / rgbSwar, wordRef, wordSwar, wordRef / wordSwar);
+  }
+}
+
+int runKernelBench(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  const uint64_t scaleErrors = checkScale();
+  const uint64_t blendErrors = checkBlend();
+  const uint64_t addErrors = checkPairs(packed::add, packed::reference::add);
+  const uint64_t subtractErrors = checkPairs(packed::subtract, packed::reference::subtract);
+  const uint64_t maxErrors = checkPairs(packed::max, packed::reference::max);
+  printf("exhaustive check against packed::reference:\n");
+  printf("  scale    %8u cases, %llu mismatches\n", 256u * 257u, static_cast<unsigned long long>(scaleErrors));
+  printf("  blend    %8u cases, %llu mismatches\n", 256u * 65536u, static_cast<unsigned long long>(blendErrors));
+  printf("  add      %8u cases, %llu mismatches\n", 65536u, static_cast<unsigned long long>(addErrors));
+  printf("  subtract %8u cases, %llu mismatches\n", 65536u, static_cast<unsigned long long>(subtractErrors));
+  printf("  max      %8u cases, %llu mismatches\n", 65536u, static_cast<unsigned long long>(maxErrors));
+
+  static Frames frames;
+  for (uint16_t index = 0; index < MaxPixelCount * 3; ++index)
+  {
+    frames.rgbA[index] = static_cast<uint8_t>(index * 37);
+    frames.rgbB[index] = static_cast<uint8_t>(index * 91 + 13);
+  }
+  for (uint16_t pixel = 0; pixel < MaxPixelCount; ++pixel)
+  {
+    const uint8_t *a = frames.rgbA + pixel * 3;
+    const uint8_t *b = frames.rgbB + pixel * 3;
+    frames.wordA[pixel] = packed::pack(a[0], a[1], a[2]);
+    frames.wordB[pixel] = packed::pack(b[0], b[1], b[2]);
+  }
+
+  printf("%u-pixel frames, per channel -> packed:\n", MaxPixelCount);
+  bench(
+      frames, "scale", [](uint8_t a, uint8_t, uint8_t k)
+      { return packed::reference::scale(a, k); },
+      [](uint32_t a, uint32_t, uint8_t k)
+      { return packed::scale(a, k); });
+  bench(
+      frames, "blend", [](uint8_t a, uint8_t b, uint8_t k)
+      { return packed::reference::blend(a, b, k); },
+      [](uint32_t a, uint32_t b, uint8_t k)
+      { return packed::blend(a, b, k); });
+  bench(
+      frames, "add", [](uint8_t a, uint8_t b, uint8_t)
+      { return packed::reference::add(a, b); },
+      [](uint32_t a, uint32_t b, uint8_t)
+      { return packed::add(a, b); });
+
+  return scaleErrors || blendErrors || addErrors || subtractErrors || maxErrors ? 1 : 0;
+}
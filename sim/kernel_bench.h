@@ -0,0 +1,10 @@
+/*
+ * Packed colour kernel mode of the native simulator: exhaustive
+ * bit-exactness against the per-channel reference, then a speed
+ * comparison. See kernel_bench.cpp.
+ */
+
+#pragma once
+
+// argv[0] is "kernels"; returns the process exit code.
+int runKernelBench(int argc, char **argv);
@@ -0,0 +1,374 @@
+/*
+ * Partitioned canvas on localhost: start one process per node.
+ * - Each node renders only its slice of a canvas-wide pattern (a hue wheel
+ *   along the whole canvas with a comet crossing it), swaps halos with its
+ *   neighbours over UDP on 127.0.0.1 and runs the post chain with them.
+ * - Frames go in lockstep: a node waits for its neighbours' halos of the
+ *   same frame. The firmware does not wait; it filters with the latest.
+ * - --check filters the same pixels as one long strip and compares, and
+ *   first runs the chain's spec parser over good and malformed specs.
+ *
+ *   for node in 0 1 2 3; do program partition --node $node --nodes 4 --check & done; wait
+ */
+
+#include "partition.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "canvas_partition.h"
+#include "lookup_tables.h"
+#include "post_filter.h"
+#include "strip_config.h"
+
+namespace
+{
+  constexpr uint16_t BasePort = 4300; // Node i listens on BasePort + i
+  constexpr int ResendMs = 50;        // Covers neighbours that start late
+  constexpr int GiveUpMs = 5000;
+  constexpr uint8_t CometLength = 24;
+  constexpr uint8_t CometSpeed = 3; // Pixels per frame
+  const char *const DefaultChain = "blur7+glow7+sharpen7"; // Reads the full HaloWidth
+
+  struct Rgb
+  {
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+
+    bool operator!=(const Rgb &other) const { return R != other.R || G != other.G || B != other.B; }
+  };
+
+  struct Options
+  {
+    CanvasSlice slice;
+    uint32_t frames = 600;
+    uint16_t port = BasePort;
+    const char *chain = DefaultChain;
+    bool check = false;
+  };
+
+  struct SpecCase
+  {
+    const char *spec;
+    bool valid;
+  };
+
+  // As a client may send them; the malformed ones end mid-stage.
+  const SpecCase SpecCases[] = {
+      {"off", true},
+      {"", true},
+      {"blur3", true},
+      {"glow5+sharpen7", true},
+      {"blur3+glow3+blur3+glow3", false}, // One stage too many
+      {"blur3+", false},
+      {"glow5+", false},
+      {"+blur3", false},
+      {"foo3", false},
+      {"blur", false},
+      {"blur4", false},
+  };
+
+  struct Node
+  {
+    Options options;
+    int socket = -1;
+    PostChain chain;
+    PostChain reference;
+    HaloExchange halos[2]; // By frame parity: a neighbour runs at most one frame ahead
+    uint8_t sent[2][HaloExchange::PacketSize] = {}; // Ours, the same way
+    std::vector<Rgb> frame;
+    std::vector<Rgb> output;
+    double renderNs = 0;
+    double postNs = 0;
+    double waitNs = 0;
+    uint32_t haloBytes = 0;
+    uint32_t mismatches = 0;
+  };
+
+  bool parseOptions(int argc, char **argv, Options &options)
+  {
+    uint32_t node = 0;
+    uint32_t nodes = 1;
+    uint32_t pixels = MaxPixelCount;
+    for (int index = 1; index < argc; ++index)
+    {
+      bool hasValue = index + 1 < argc;
+      if (strcmp(argv[index], "--check") == 0)
+      {
+        options.check = true;
+      }
+      else if (strcmp(argv[index], "--node") == 0 && hasValue)
+      {
+        node = strtoul(argv[++index], nullptr, 10);
+      }
+      else if (strcmp(argv[index], "--nodes") == 0 && hasValue)
+      {
+        nodes = strtoul(argv[++index], nullptr, 10);
+      }
+      else if (strcmp(argv[index], "--pixels") == 0 && hasValue)
+      {
+        pixels = strtoul(argv[++index], nullptr, 10);
+      }
+      else if (strcmp(argv[index], "--frames") == 0 && hasValue)
+      {
+        options.frames = strtoul(argv[++index], nullptr, 10);
+      }
+      else if (strcmp(argv[index], "--port") == 0 && hasValue)
+      {
+        options.port = static_cast<uint16_t>(strtoul(argv[++index], nullptr, 10));
+      }
+      else if (strcmp(argv[index], "--chain") == 0 && hasValue)
+      {
+        options.chain = argv[++index];
+      }
+      else
+      {
+        return false;
+      }
+    }
+    if (nodes < 1 || nodes > HaloExchange::MaxNodes || node >= nodes || pixels < 1 || pixels > MaxPixelCount ||
+        !options.frames)
+    {
+      return false;
+    }
+    options.slice.node = static_cast<uint8_t>(node);
+    options.slice.nodes = static_cast<uint8_t>(nodes);
+    options.slice.count = static_cast<uint16_t>(pixels);
+    return true;
+  }
+
+  // Depends only on the canvas position and frame, like an effect driven by
+  // the shared show clock; the comet gives every seam hard edges to cross.
+  Rgb canvasPixel(uint32_t position, uint32_t canvasCount, uint32_t frameIndex)
+  {
+    uint32_t head = frameIndex * CometSpeed % canvasCount;
+    uint32_t behind = (head + canvasCount - position) % canvasCount;
+    if (behind < CometLength)
+    {
+      uint8_t level = static_cast<uint8_t>(255 - behind * 255 / CometLength);
+      return {level, level, level};
+    }
+    const lut::Rgb8 &hue = lut::HueWheel[(position * 256 / canvasCount + frameIndex) & 0xFF];
+    return {static_cast<uint8_t>(hue.r / 4), static_cast<uint8_t>(hue.g / 4), static_cast<uint8_t>(hue.b / 4)};
+  }
+
+  // Each spec is copied to an exact-size heap block, so a read past its
+  // terminator shows up under AddressSanitizer.
+  uint8_t checkSpecs()
+  {
+    uint8_t failures = 0;
+    for (const SpecCase &specCase : SpecCases)
+    {
+      std::vector<char> spec(specCase.spec, specCase.spec + strlen(specCase.spec) + 1);
+      if (PostChain::valid(spec.data()) != specCase.valid)
+      {
+        printf("  post chain spec \"%s\" should be %s\n", specCase.spec, specCase.valid ? "valid" : "rejected");
+        ++failures;
+      }
+    }
+    return failures;
+  }
+
+  bool openSocket(Node &node)
+  {
+    node.socket = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(node.options.port + node.options.slice.node);
+    return node.socket >= 0 && bind(node.socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+  }
+
+  void sendTo(const Node &node, uint8_t neighbour, const uint8_t *packet, size_t length)
+  {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(node.options.port + neighbour);
+    sendto(node.socket, packet, length, 0, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+  }
+
+  // The ESP32 broadcasts one packet; here each neighbour gets its own copy.
+  void sendHalo(Node &node, const uint8_t *packet, size_t length)
+  {
+    const CanvasSlice &slice = node.options.slice;
+    if (slice.hasLeft())
+    {
+      sendTo(node, slice.node - 1, packet, length);
+    }
+    if (slice.hasRight())
+    {
+      sendTo(node, slice.node + 1, packet, length);
+    }
+  }
+
+  bool haloReady(const Node &node, uint16_t sequence)
+  {
+    const CanvasSlice &slice = node.options.slice;
+    const HaloExchange &halos = node.halos[sequence & 1];
+    return (!slice.hasLeft() || (halos.left() && halos.leftSequence() == sequence)) &&
+           (!slice.hasRight() || (halos.right() && halos.rightSequence() == sequence));
+  }
+
+  // Takes packets until both neighbours' halos for `sequence` are in. While
+  // waiting it sends our last two again: a neighbour that started late may
+  // still need the previous one. False if a neighbour never shows up.
+  bool awaitHalos(Node &node, uint16_t sequence)
+  {
+    int waitedMs = 0;
+    while (!haloReady(node, sequence))
+    {
+      pollfd readable = {node.socket, POLLIN, 0};
+      if (poll(&readable, 1, ResendMs) <= 0)
+      {
+        waitedMs += ResendMs;
+        if (waitedMs >= GiveUpMs)
+        {
+          return false;
+        }
+        sendHalo(node, node.sent[(sequence - 1) & 1], HaloExchange::PacketSize);
+        sendHalo(node, node.sent[sequence & 1], HaloExchange::PacketSize);
+        continue;
+      }
+
+      uint8_t packet[HaloExchange::PacketSize];
+      ssize_t length = recv(node.socket, packet, sizeof(packet), 0);
+      if (length == static_cast<ssize_t>(HaloExchange::PacketSize))
+      {
+        node.halos[HaloExchange::sequence(packet) & 1].receive(node.options.slice, packet, length);
+        node.haloBytes += length;
+      }
+    }
+    return true;
+  }
+
+  // The slice filtered as part of one long strip, a window at a time: each
+  // window reaches HaloWidth past the pixels kept (clipped at the canvas
+  // ends), which is as far as the chain's edge handling can reach in.
+  bool matchesReference(Node &node, uint32_t frameIndex)
+  {
+    constexpr uint16_t Halo = PostChain::HaloWidth;
+    constexpr uint16_t Chunk = MaxPixelCount - 2 * Halo;
+    const CanvasSlice &slice = node.options.slice;
+    const uint32_t canvasCount = slice.canvasCount();
+    Rgb window[MaxPixelCount];
+    Rgb filtered[MaxPixelCount];
+
+    for (uint16_t start = 0; start < slice.count; start += Chunk)
+    {
+      uint32_t first = slice.offset() + start;
+      uint32_t count = slice.count - start < Chunk ? slice.count - start : Chunk;
+      uint32_t from = first >= Halo ? first - Halo : 0;
+      uint32_t to = first + count + Halo < canvasCount ? first + count + Halo : canvasCount;
+      for (uint32_t position = from; position < to; ++position)
+      {
+        window[position - from] = canvasPixel(position, canvasCount, frameIndex);
+      }
+      node.reference.apply(window, filtered, static_cast<uint16_t>(to - from));
+      for (uint32_t pixel = 0; pixel < count; ++pixel)
+      {
+        if (filtered[first - from + pixel] != node.output[start + pixel])
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  template <typename Step>
+  void timed(double &totalNs, Step step)
+  {
+    auto start = std::chrono::steady_clock::now();
+    step();
+    totalNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  bool runFrame(Node &node, uint32_t frameIndex)
+  {
+    const CanvasSlice &slice = node.options.slice;
+    const uint16_t sequence = static_cast<uint16_t>(frameIndex);
+
+    timed(node.renderNs, [&]
+          {
+            for (uint16_t pixel = 0; pixel < slice.count; ++pixel)
+            {
+              node.frame[pixel] = canvasPixel(slice.offset() + pixel, slice.canvasCount(), frameIndex);
+            } });
+
+    uint8_t *packet = node.sent[sequence & 1];
+    HaloExchange::encode(slice, sequence, node.frame.data(), packet);
+    sendHalo(node, packet, HaloExchange::PacketSize);
+    bool ready = true;
+    timed(node.waitNs, [&]
+          { ready = awaitHalos(node, sequence); });
+    if (!ready)
+    {
+      return false;
+    }
+
+    const HaloExchange &halos = node.halos[sequence & 1];
+    timed(node.postNs, [&]
+          { node.chain.apply(node.frame.data(), node.output.data(), slice.count, halos.left(), halos.right()); });
+
+    if (node.options.check && !matchesReference(node, frameIndex))
+    {
+      ++node.mismatches;
+    }
+    return true;
+  }
+}
+
+int runPartition(int argc, char **argv)
+{
+  Node node;
+  if (!parseOptions(argc, argv, node.options) || !node.chain.configure(node.options.chain, 160) ||
+      !node.reference.configure(node.options.chain, 160))
+  {
+    fprintf(stderr,
+            "usage: %s --node I --nodes N [--pixels N] [--frames N] [--port P] [--chain SPEC] [--check]\n",
+            argv[0]);
+    return 2;
+  }
+  const CanvasSlice &slice = node.options.slice;
+  uint8_t specFailures = node.options.check ? checkSpecs() : 0;
+  if (!openSocket(node))
+  {
+    fprintf(stderr, "node %u: cannot bind 127.0.0.1:%u\n", slice.node, node.options.port + slice.node);
+    return 1;
+  }
+  node.frame.resize(slice.count);
+  node.output.resize(slice.count);
+
+  uint32_t frames = 0;
+  for (; frames < node.options.frames; ++frames)
+  {
+    if (!runFrame(node, frames))
+    {
+      fprintf(stderr, "node %u: no halo from a neighbour for frame %u\n", slice.node, frames);
+      break;
+    }
+  }
+  close(node.socket);
+
+  double perLed = 1.0 / (frames ? frames : 1) / slice.count;
+  printf("node %u/%u: pixels %u-%u of %u, %u frames, chain %s\n", slice.node, slice.nodes, slice.offset(),
+         slice.offset() + slice.count - 1, slice.canvasCount(), frames, node.chain.spec());
+  printf("  render %.2f ns/LED, post %.2f ns/LED, halo wait %.3f ms/frame, halos in %u bytes/frame\n",
+         node.renderNs * perLed, node.postNs * perLed, node.waitNs / (frames ? frames : 1) / 1e6,
+         frames ? node.haloBytes / frames : 0);
+  if (node.options.check)
+  {
+    printf("  %u of %u frames differ from one long strip\n", node.mismatches, frames);
+  }
+  return frames == node.options.frames && !node.mismatches && !specFailures ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+/*
+ * Partitioned-canvas mode of the native simulator: one process per node,
+ * halos over UDP on localhost. See partition.cpp.
+ */
+
+#pragma once
+
+// argv[0] is "partition"; returns the process exit code.
+int runPartition(int argc, char **argv);
@@ -0,0 +1,309 @@
+/*
+ * Native simulator: a whole camp of spiral logos on one Linux box.
+ * - Every logo renders the firmware's radar beam (effects.h) over the real
+ *   spiral geometry, then the camp goes through the packed run kernels as
+ *   one long run of pixels, vectorised with AVX2/SSE2 where the host has
+ *   them. Trails are the firmware's; the flash overlay, accent and
+ *   brightness are a synthetic load, not the firmware's compositing.
+ * - Fan-out packs one DDP packet per logo, as a render server would send.
+ * - --check runs the scalar run kernels alongside and compares every frame
+ *   bit for bit, and reports the speed-up. It also folds every logo with
+ *   the firmware's own trails::fold on RGB bytes, as the device does, and
+ *   compares that history with the run kernels'.
+ * - "partition" as the first argument runs one node of a partitioned
+ *   canvas instead (partition.cpp); "json" benchmarks the request body
+ *   parser (json_bench.cpp), "kernels" checks and times the packed colour
+ *   kernels (kernel_bench.cpp) and "gif" the GIF decoder (gif_bench.cpp).
+ *
+ *   pio run -e native && .pio/build/native/program --logos 720 --check
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "color_runs.h"
+#include "ddp.h"
+#include "effects.h"
+#include "gif_bench.h"
+#include "json_bench.h"
+#include "kernel_bench.h"
+#include "partition.h"
+#include "packed_color.h"
+#include "spiral_geometry.h"
+#include "strip_config.h"
+#include "trails.h"
+
+namespace
+{
+  constexpr uint32_t FramePeriodMs = 16;
+  constexpr uint8_t TrailDecay = 230;
+  constexpr uint8_t Brightness = 160;
+  constexpr uint32_t FlashEveryFrames = 60; // A tenth of the camp flashes this often
+  constexpr uint32_t FlashFrames = 30;
+
+  struct Options
+  {
+    size_t logos = 720; // 103,680 LEDs
+    uint32_t frames = 600;
+    bool check = false;
+  };
+
+  struct Kernels
+  {
+    void (*dim)(uint32_t *, size_t, uint8_t);
+    void (*blend)(uint32_t *, const uint32_t *, size_t, uint8_t);
+    void (*add)(uint32_t *, const uint32_t *, size_t);
+    bool (*trail)(uint32_t *, const uint32_t *, size_t, uint8_t);
+  };
+
+  const Kernels Vectorised = {runs::dim, runs::blend, runs::add, runs::trail};
+  const Kernels Scalar = {runs::scalar::dim, runs::scalar::blend, runs::scalar::add, runs::scalar::trail};
+
+  enum Stage
+  {
+    Render,
+    Trails,
+    Composite,
+    FanOut,
+    StageCount
+  };
+
+  const char *const StageNames[] = {"render", "trails", "composite", "fan-out"};
+
+  struct Camp
+  {
+    explicit Camp(size_t logos)
+        : logos(logos), pixels(logos * MaxPixelCount), frame(pixels), history(pixels), output(pixels),
+          packets(logos * (ddp::HeaderSize + MaxPixelCount * 3)), radars(logos)
+    {
+    }
+
+    size_t logos;
+    size_t pixels;
+    std::vector<uint32_t> frame;
+    std::vector<uint32_t> history;
+    std::vector<uint32_t> output;
+    std::vector<uint8_t> packets;
+    std::vector<effects::Radar> radars;
+    double stageNs[StageCount] = {};
+  };
+
+  // The device's pixel layout, for trails::fold.
+  struct Rgb
+  {
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+  };
+
+  // Shared layers: a flash colour and a sparse accent added on top.
+  std::vector<uint32_t> flashLayer;
+  std::vector<uint32_t> accentLayer;
+
+  bool parseOptions(int argc, char **argv, Options &options)
+  {
+    for (int index = 1; index < argc; ++index)
+    {
+      if (strcmp(argv[index], "--check") == 0)
+      {
+        options.check = true;
+      }
+      else if (strcmp(argv[index], "--logos") == 0 && index + 1 < argc)
+      {
+        options.logos = strtoul(argv[++index], nullptr, 10);
+      }
+      else if (strcmp(argv[index], "--frames") == 0 && index + 1 < argc)
+      {
+        options.frames = strtoul(argv[++index], nullptr, 10);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return options.logos && options.frames;
+  }
+
+  // Radar beam per logo, each with its own phase and colour, painted as
+  // the firmware paints it.
+  void renderRadar(Camp &camp, const SpiralGeometry &geometry, uint32_t nowMs)
+  {
+    for (size_t logo = 0; logo < camp.logos; ++logo)
+    {
+      uint16_t lead = effects::radarLead(static_cast<uint32_t>(nowMs + logo * 97));
+      uint32_t color = packed::pack(static_cast<uint8_t>(logo * 53), static_cast<uint8_t>(255 - logo * 29), 180);
+      uint32_t *pixels = camp.frame.data() + logo * MaxPixelCount;
+      camp.radars[logo].render(geometry, lead, [&](uint16_t pixel, uint8_t level)
+                               { pixels[pixel] = packed::dim(color, level); });
+    }
+  }
+
+  void composite(Camp &camp, const Kernels &kernels, uint32_t frameIndex)
+  {
+    memcpy(camp.output.data(), camp.history.data(), camp.pixels * sizeof(uint32_t));
+
+    uint32_t sinceFlash = frameIndex % FlashEveryFrames;
+    if (sinceFlash < FlashFrames)
+    {
+      // A different tenth of the camp each time, fading out.
+      size_t group = camp.logos / 10 ? camp.logos / 10 : 1;
+      size_t first = (frameIndex / FlashEveryFrames * group) % camp.logos;
+      size_t count = (first + group > camp.logos ? camp.logos - first : group) * MaxPixelCount;
+      uint8_t progress = static_cast<uint8_t>(255 - sinceFlash * 255 / FlashFrames);
+      kernels.blend(camp.output.data() + first * MaxPixelCount, flashLayer.data(), count, progress);
+    }
+
+    kernels.add(camp.output.data(), accentLayer.data(), camp.pixels);
+    kernels.dim(camp.output.data(), camp.pixels, Brightness);
+  }
+
+  void fanOut(Camp &camp, uint8_t sequence)
+  {
+    uint8_t *packet = camp.packets.data();
+    for (size_t logo = 0; logo < camp.logos; ++logo)
+    {
+      packet += ddp::writeHeader(packet, sequence, 0, MaxPixelCount * 3, true);
+
+      const uint32_t *pixels = camp.output.data() + logo * MaxPixelCount;
+      for (uint16_t pixel = 0; pixel < MaxPixelCount; ++pixel)
+      {
+        *packet++ = packed::red(pixels[pixel]);
+        *packet++ = packed::green(pixels[pixel]);
+        *packet++ = packed::blue(pixels[pixel]);
+      }
+    }
+  }
+
+  // The frame just rendered, folded logo by logo as the firmware folds its
+  // RgbColor frame; true if the history matches the run kernels' bit for bit.
+  bool matchesDeviceTrails(const Camp &camp, std::vector<Rgb> &frame, std::vector<Rgb> &history)
+  {
+    for (size_t pixel = 0; pixel < camp.pixels; ++pixel)
+    {
+      uint32_t color = camp.frame[pixel];
+      frame[pixel] = {packed::red(color), packed::green(color), packed::blue(color)};
+    }
+    bool matches = true;
+    for (size_t logo = 0; logo < camp.logos; ++logo)
+    {
+      size_t first = logo * MaxPixelCount;
+      trails::fold(frame.data() + first, history.data() + first, MaxPixelCount, TrailDecay);
+      for (size_t pixel = first; pixel < first + MaxPixelCount; ++pixel)
+      {
+        uint32_t color = camp.history[pixel];
+        const Rgb &device = history[pixel];
+        matches &= device.R == packed::red(color) && device.G == packed::green(color) &&
+                   device.B == packed::blue(color);
+      }
+    }
+    return matches;
+  }
+
+  template <typename Step>
+  void timed(Camp &camp, Stage stage, Step step)
+  {
+    auto start = std::chrono::steady_clock::now();
+    step();
+    camp.stageNs[stage] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  void runFrame(Camp &camp, const Kernels &kernels, const SpiralGeometry &geometry, uint32_t frameIndex)
+  {
+    timed(camp, Render, [&]
+          { renderRadar(camp, geometry, frameIndex * FramePeriodMs); });
+    timed(camp, Trails, [&]
+          { kernels.trail(camp.history.data(), camp.frame.data(), camp.pixels, TrailDecay); });
+    timed(camp, Composite, [&]
+          { composite(camp, kernels, frameIndex); });
+    timed(camp, FanOut, [&]
+          { fanOut(camp, static_cast<uint8_t>(frameIndex)); });
+  }
+
+  double report(const char *name, const Camp &camp, uint32_t frames)
+  {
+    double totalNs = 0;
+    printf("%s:\n", name);
+    for (uint8_t stage = 0; stage < StageCount; ++stage)
+    {
+      double perLed = camp.stageNs[stage] / frames / camp.pixels;
+      printf("  %-10s %7.3f ns/LED\n", StageNames[stage], perLed);
+      totalNs += camp.stageNs[stage];
+    }
+    double frameMs = totalNs / frames / 1e6;
+    printf("  frame      %7.3f ms (%.0f fps possible, budget %u ms)\n", frameMs, 1000.0 / frameMs, FramePeriodMs);
+    return camp.stageNs[Trails] + camp.stageNs[Composite];
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && strcmp(argv[1], "partition") == 0)
+  {
+    return runPartition(argc - 1, argv + 1);
+  }
+  if (argc > 1 && strcmp(argv[1], "json") == 0)
+  {
+    return runJsonBench(argc - 1, argv + 1);
+  }
+  if (argc > 1 && strcmp(argv[1], "kernels") == 0)
+  {
+    return runKernelBench(argc - 1, argv + 1);
+  }
+  if (argc > 1 && strcmp(argv[1], "gif") == 0)
+  {
+    return runGifBench(argc - 1, argv + 1);
+  }
+
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    fprintf(stderr, "usage: %s [--logos N] [--frames N] [--check] | partition ... | json | kernels | gif\n", argv[0]);
+    return 2;
+  }
+
+  SpiralGeometry geometry;
+  geometry.build(MaxPixelCount);
+
+  flashLayer.assign(options.logos * MaxPixelCount, packed::pack(255, 255, 255));
+  accentLayer.assign(options.logos * MaxPixelCount, 0);
+  for (size_t pixel = 0; pixel < accentLayer.size(); pixel += 8)
+  {
+    accentLayer[pixel] = packed::pack(24, 24, 32);
+  }
+
+  Camp camp(options.logos);
+  Camp reference(options.check ? options.logos : 0);
+  std::vector<Rgb> deviceFrame(reference.pixels);
+  std::vector<Rgb> deviceHistory(reference.pixels);
+  uint32_t mismatches = 0;
+  uint32_t trailMismatches = 0;
+
+  for (uint32_t frameIndex = 0; frameIndex < options.frames; ++frameIndex)
+  {
+    runFrame(camp, Vectorised, geometry, frameIndex);
+    if (options.check)
+    {
+      runFrame(reference, Scalar, geometry, frameIndex);
+      mismatches += camp.packets != reference.packets || camp.history != reference.history;
+      trailMismatches += !matchesDeviceTrails(camp, deviceFrame, deviceHistory);
+    }
+  }
+
+  size_t packetBytes = camp.packets.size();
+  printf("%zu logos, %zu LEDs, %u frames, kernels: %s\n", camp.logos, camp.pixels, options.frames, runs::backend());
+  double kernelNs = report(runs::backend(), camp, options.frames);
+  printf("  fan-out    %zu bytes/frame, %.1f Mbit/s at %u ms frames\n", packetBytes,
+         packetBytes * 8.0 / FramePeriodMs / 1000.0, FramePeriodMs);
+
+  if (options.check)
+  {
+    double scalarNs = report("scalar", reference, options.frames);
+    printf("kernel speed-up %.2fx, %u of %u frames differ\n", scalarNs / kernelNs, mismatches, options.frames);
+    printf("trails against the firmware's trails::fold: %u of %u frames differ\n", trailMismatches, options.frames);
+    return mismatches || trailMismatches ? 1 : 0;
+  }
+  return 0;
+}
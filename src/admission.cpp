@@ -0,0 +1,102 @@
+#include "admission.h"
+
+void AdmissionControl::recordFrame(uint32_t usedUs)
+{
+  // Exponential average over ~8 frames: one slow frame doesn't shed load,
+  // a sustained squeeze does within a few frames.
+  int32_t delta = static_cast<int32_t>(usedUs) - static_cast<int32_t>(averageUsedUs);
+  averageUsedUs += delta / 8;
+
+  slack = averageUsedUs >= frameBudgetUs
+              ? 0
+              : static_cast<uint8_t>(100 - averageUsedUs * 100 / frameBudgetUs);
+}
+
+void AdmissionControl::refill(Bucket &bucket, uint32_t nowMs, uint32_t perSecond, uint16_t burst)
+{
+  uint32_t elapsed = nowMs - bucket.refilledMs;
+  bucket.refilledMs = nowMs;
+
+  uint32_t limit = static_cast<uint32_t>(burst) * TokenScale;
+  uint64_t tokens = bucket.tokens + static_cast<uint64_t>(elapsed) * perSecond; // ms x per-second = milli-tokens
+  bucket.tokens = tokens > limit ? limit : static_cast<uint32_t>(tokens);
+}
+
+// Unknown clients take the least recently seen slot and start with a full
+// burst, so a page load from a new phone isn't throttled.
+AdmissionControl::Client &AdmissionControl::clientFor(uint32_t address, uint32_t nowMs)
+{
+  Client *oldest = &clients[0];
+  for (Client &client : clients)
+  {
+    if (client.address == address && client.lastSeenMs)
+    {
+      client.lastSeenMs = nowMs;
+      return client;
+    }
+    if (nowMs - client.lastSeenMs > nowMs - oldest->lastSeenMs)
+    {
+      oldest = &client;
+    }
+  }
+
+  oldest->address = address;
+  oldest->bucket.tokens = static_cast<uint32_t>(ClientBurst) * TokenScale;
+  oldest->bucket.refilledMs = nowMs;
+  oldest->lastSeenMs = nowMs ? nowMs : 1;
+  return *oldest;
+}
+
+bool AdmissionControl::reject()
+{
+  ++rejectedCount;
+  return false;
+}
+
+bool AdmissionControl::admit(uint32_t address, RequestClass kind, uint32_t nowMs)
+{
+  uint8_t currentSlack = slack;
+
+  uint8_t limit = kind == RequestClass::Control ? MaxInFlight : MaxInFlight - ControlReserve;
+  if (active >= limit)
+  {
+    return reject();
+  }
+  if ((kind == RequestClass::State && currentSlack < StateMinSlack) ||
+      (kind == RequestClass::Static && currentSlack < StaticMinSlack))
+  {
+    return reject();
+  }
+
+  Client &client = clientFor(address, nowMs);
+  refill(client.bucket, nowMs, ClientRate, ClientBurst);
+  if (client.bucket.tokens < TokenScale)
+  {
+    return reject();
+  }
+
+  // The global budget shrinks with slack; control requests still draw from
+  // it but are admitted when it runs dry.
+  uint32_t globalRate = GlobalRate * (currentSlack < 25 ? 25 : currentSlack) / 100;
+  refill(global, nowMs, globalRate, GlobalBurst);
+  if (global.tokens >= TokenScale)
+  {
+    global.tokens -= TokenScale;
+  }
+  else if (kind != RequestClass::Control)
+  {
+    return reject();
+  }
+
+  client.bucket.tokens -= TokenScale;
+  ++active;
+  return true;
+}
+
+void AdmissionControl::release()
+{
+  if (active)
+  {
+    --active;
+  }
+}
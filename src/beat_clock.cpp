@@ -0,0 +1,66 @@
+#include "beat_clock.h"
+
+uint32_t BeatClock::position(uint32_t nowMs) const
+{
+  if (!centiBpm)
+  {
+    return 0;
+  }
+  uint64_t elapsed = nowMs - anchorMs;
+  return static_cast<uint32_t>((elapsed * centiBpm * 65536ULL) / 6000000ULL);
+}
+
+void BeatClock::setBpm(uint16_t value, uint32_t nowMs)
+{
+  if (value < MinCentiBpm || value > MaxCentiBpm)
+  {
+    return;
+  }
+
+  uint16_t currentPhase = centiBpm ? static_cast<uint16_t>(position(nowMs)) : 0;
+  centiBpm = value;
+  anchorMs = nowMs - static_cast<uint32_t>((static_cast<uint64_t>(currentPhase) * periodMs()) >> 16);
+}
+
+void BeatClock::tap(uint32_t nowMs)
+{
+  if (tapCount && nowMs - taps[tapCount - 1] > TapTimeoutMs)
+  {
+    tapCount = 0;
+  }
+
+  if (tapCount == MaxTaps)
+  {
+    for (uint8_t i = 1; i < MaxTaps; ++i)
+    {
+      taps[i - 1] = taps[i];
+    }
+    --tapCount;
+  }
+  taps[tapCount++] = nowMs;
+
+  if (tapCount < 2)
+  {
+    return;
+  }
+
+  uint32_t interval = (taps[tapCount - 1] - taps[0]) / (tapCount - 1);
+  if (interval == 0)
+  {
+    return;
+  }
+  uint32_t value = 6000000UL / interval;
+  if (value < MinCentiBpm || value > MaxCentiBpm)
+  {
+    return;
+  }
+  centiBpm = static_cast<uint16_t>(value);
+  anchorMs = nowMs;
+}
+
+void BeatClock::update(uint32_t nowMs)
+{
+  uint32_t beats = position(nowMs);
+  beatCount = beats >> 16;
+  beatPhase = static_cast<uint16_t>(beats);
+}
@@ -0,0 +1,54 @@
+#include "canvas_partition.h"
+
+#include <string.h>
+
+int8_t HaloExchange::side(const CanvasSlice &slice, const uint8_t *packet, size_t length)
+{
+  if (length != PacketSize || packet[0] != 'H' || packet[1] != slice.nodes || packet[5] != Width)
+  {
+    return 0;
+  }
+  uint8_t sender = packet[2];
+  return sender + 1 == slice.node ? -1 : sender == slice.node + 1 ? 1 : 0;
+}
+
+// A left neighbour's last pixels are our left halo, a right neighbour's
+// first pixels our right one.
+bool HaloExchange::receive(const CanvasSlice &slice, const uint8_t *packet, size_t length)
+{
+  int8_t from = side(slice, packet, length);
+  if (!from)
+  {
+    return false;
+  }
+
+  const uint8_t *edge = packet + HeaderSize + (from < 0 ? Width * 3 : 0);
+  uint8_t *halo = from < 0 ? leftEdge : rightEdge;
+  uint8_t &age = from < 0 ? leftAge : rightAge;
+  (from < 0 ? leftSeq : rightSeq) = sequence(packet);
+
+  bool changed = age >= MaxAge || memcmp(halo, edge, Width * 3) != 0;
+  memcpy(halo, edge, Width * 3);
+  age = 0;
+  return changed;
+}
+
+bool HaloExchange::advance()
+{
+  bool expired = false;
+  uint8_t *ages[] = {&leftAge, &rightAge};
+  for (uint8_t *age : ages)
+  {
+    if (*age < MaxAge)
+    {
+      expired |= ++*age == MaxAge;
+    }
+  }
+  return expired;
+}
+
+void HaloExchange::clear()
+{
+  leftAge = MaxAge;
+  rightAge = MaxAge;
+}
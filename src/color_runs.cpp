@@ -0,0 +1,200 @@
+#include "color_runs.h"
+
+#include "packed_color.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace runs
+{
+  namespace scalar
+  {
+    void dim(uint32_t *pixels, size_t count, uint8_t level)
+    {
+      for (size_t index = 0; index < count; ++index)
+      {
+        pixels[index] = packed::dim(pixels[index], level);
+      }
+    }
+
+    void blend(uint32_t *target, const uint32_t *source, size_t count, uint8_t progress)
+    {
+      for (size_t index = 0; index < count; ++index)
+      {
+        target[index] = packed::blend(target[index], source[index], progress);
+      }
+    }
+
+    void add(uint32_t *target, const uint32_t *source, size_t count)
+    {
+      for (size_t index = 0; index < count; ++index)
+      {
+        target[index] = packed::add(target[index], source[index]);
+      }
+    }
+
+    bool trail(uint32_t *history, const uint32_t *frame, size_t count, uint8_t decay)
+    {
+      bool fading = false;
+      for (size_t index = 0; index < count; ++index)
+      {
+        uint32_t out = packed::max(frame[index], packed::scale(history[index], decay));
+        fading |= out != frame[index];
+        history[index] = out;
+      }
+      return fading;
+    }
+  }
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+// One set of vector kernels; the wrappers below pick the register width.
+// Channels are widened to 16-bit lanes for the multiplies, where the
+// largest product (255 * 256) still fits, then narrowed back.
+namespace
+{
+#if defined(__AVX2__)
+  using Vector = __m256i;
+  constexpr size_t Lanes = 8;
+  constexpr int AllEqual = -1;
+  const char *const Backend = "avx2";
+
+  inline Vector load(const uint32_t *pixels) { return _mm256_loadu_si256(reinterpret_cast<const Vector *>(pixels)); }
+  inline void store(uint32_t *pixels, Vector value) { _mm256_storeu_si256(reinterpret_cast<Vector *>(pixels), value); }
+  inline Vector zero() { return _mm256_setzero_si256(); }
+  inline Vector broadcast16(uint16_t value) { return _mm256_set1_epi16(static_cast<int16_t>(value)); }
+  inline Vector widenLow(Vector value) { return _mm256_unpacklo_epi8(value, zero()); }
+  inline Vector widenHigh(Vector value) { return _mm256_unpackhi_epi8(value, zero()); }
+  inline Vector narrow(Vector low, Vector high) { return _mm256_packus_epi16(low, high); }
+  inline Vector multiply16(Vector a, Vector b) { return _mm256_mullo_epi16(a, b); }
+  inline Vector add16(Vector a, Vector b) { return _mm256_add_epi16(a, b); }
+  inline Vector shift16(Vector value) { return _mm256_srli_epi16(value, 8); }
+  inline Vector addSaturated(Vector a, Vector b) { return _mm256_adds_epu8(a, b); }
+  inline Vector max8(Vector a, Vector b) { return _mm256_max_epu8(a, b); }
+  inline int equalMask(Vector a, Vector b) { return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)); }
+#else
+  using Vector = __m128i;
+  constexpr size_t Lanes = 4;
+  constexpr int AllEqual = 0xFFFF;
+  const char *const Backend = "sse2";
+
+  inline Vector load(const uint32_t *pixels) { return _mm_loadu_si128(reinterpret_cast<const Vector *>(pixels)); }
+  inline void store(uint32_t *pixels, Vector value) { _mm_storeu_si128(reinterpret_cast<Vector *>(pixels), value); }
+  inline Vector zero() { return _mm_setzero_si128(); }
+  inline Vector broadcast16(uint16_t value) { return _mm_set1_epi16(static_cast<int16_t>(value)); }
+  inline Vector widenLow(Vector value) { return _mm_unpacklo_epi8(value, zero()); }
+  inline Vector widenHigh(Vector value) { return _mm_unpackhi_epi8(value, zero()); }
+  inline Vector narrow(Vector low, Vector high) { return _mm_packus_epi16(low, high); }
+  inline Vector multiply16(Vector a, Vector b) { return _mm_mullo_epi16(a, b); }
+  inline Vector add16(Vector a, Vector b) { return _mm_add_epi16(a, b); }
+  inline Vector shift16(Vector value) { return _mm_srli_epi16(value, 8); }
+  inline Vector addSaturated(Vector a, Vector b) { return _mm_adds_epu8(a, b); }
+  inline Vector max8(Vector a, Vector b) { return _mm_max_epu8(a, b); }
+  inline int equalMask(Vector a, Vector b) { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)); }
+#endif
+
+  // channel * factor / 256 on every byte.
+  inline Vector scale(Vector value, Vector factor)
+  {
+    return narrow(shift16(multiply16(widenLow(value), factor)), shift16(multiply16(widenHigh(value), factor)));
+  }
+
+  size_t vectorCount(size_t count)
+  {
+    return count - count % Lanes;
+  }
+}
+
+namespace runs
+{
+  void dim(uint32_t *pixels, size_t count, uint8_t level)
+  {
+    const Vector factor = broadcast16(level + 1);
+    const size_t whole = vectorCount(count);
+    for (size_t index = 0; index < whole; index += Lanes)
+    {
+      store(pixels + index, scale(load(pixels + index), factor));
+    }
+    scalar::dim(pixels + whole, count - whole, level);
+  }
+
+  void blend(uint32_t *target, const uint32_t *source, size_t count, uint8_t progress)
+  {
+    const Vector toWeight = broadcast16(progress + 1);
+    const Vector fromWeight = broadcast16(255 - progress);
+    const size_t whole = vectorCount(count);
+    for (size_t index = 0; index < whole; index += Lanes)
+    {
+      Vector from = load(target + index);
+      Vector to = load(source + index);
+      Vector low = add16(multiply16(widenLow(from), fromWeight), multiply16(widenLow(to), toWeight));
+      Vector high = add16(multiply16(widenHigh(from), fromWeight), multiply16(widenHigh(to), toWeight));
+      store(target + index, narrow(shift16(low), shift16(high)));
+    }
+    scalar::blend(target + whole, source + whole, count - whole, progress);
+  }
+
+  void add(uint32_t *target, const uint32_t *source, size_t count)
+  {
+    const size_t whole = vectorCount(count);
+    for (size_t index = 0; index < whole; index += Lanes)
+    {
+      store(target + index, addSaturated(load(target + index), load(source + index)));
+    }
+    scalar::add(target + whole, source + whole, count - whole);
+  }
+
+  bool trail(uint32_t *history, const uint32_t *frame, size_t count, uint8_t decay)
+  {
+    const Vector factor = broadcast16(decay);
+    const size_t whole = vectorCount(count);
+    bool fading = false;
+    for (size_t index = 0; index < whole; index += Lanes)
+    {
+      Vector fresh = load(frame + index);
+      Vector out = max8(fresh, scale(load(history + index), factor));
+      fading |= equalMask(out, fresh) != AllEqual;
+      store(history + index, out);
+    }
+    return scalar::trail(history + whole, frame + whole, count - whole, decay) || fading;
+  }
+
+  const char *backend()
+  {
+    return Backend;
+  }
+}
+
+#else
+
+namespace runs
+{
+  void dim(uint32_t *pixels, size_t count, uint8_t level)
+  {
+    scalar::dim(pixels, count, level);
+  }
+
+  void blend(uint32_t *target, const uint32_t *source, size_t count, uint8_t progress)
+  {
+    scalar::blend(target, source, count, progress);
+  }
+
+  void add(uint32_t *target, const uint32_t *source, size_t count)
+  {
+    scalar::add(target, source, count);
+  }
+
+  bool trail(uint32_t *history, const uint32_t *frame, size_t count, uint8_t decay)
+  {
+    return scalar::trail(history, frame, count, decay);
+  }
+
+  const char *backend()
+  {
+    return "scalar";
+  }
+}
+
+#endif
@@ -0,0 +1,73 @@
+#include "ddp.h"
+
+#include <string.h>
+
+namespace ddp
+{
+  size_t writeHeader(uint8_t *packet, uint8_t sequence, uint32_t offset, uint16_t length, bool push)
+  {
+    packet[0] = Version1 | (push ? Push : 0);
+    packet[1] = sequence & 0x0F;
+    packet[2] = TypeRgb8;
+    packet[3] = DisplayId;
+    packet[4] = static_cast<uint8_t>(offset >> 24);
+    packet[5] = static_cast<uint8_t>(offset >> 16);
+    packet[6] = static_cast<uint8_t>(offset >> 8);
+    packet[7] = static_cast<uint8_t>(offset);
+    packet[8] = static_cast<uint8_t>(length >> 8);
+    packet[9] = static_cast<uint8_t>(length);
+    return HeaderSize;
+  }
+
+  // Senders differ on the data type byte (0 is common for "default RGB"),
+  // so any type is taken as 8-bit RGB.
+  bool parse(const uint8_t *packet, size_t size, Packet &out)
+  {
+    if (size < HeaderSize || (packet[0] & VersionMask) != Version1)
+    {
+      return false;
+    }
+    size_t header = HeaderSize + ((packet[0] & Timecode) ? TimecodeSize : 0);
+    out.sequence = packet[1] & 0x0F;
+    out.push = packet[0] & Push;
+    out.offset = static_cast<uint32_t>(packet[4]) << 24 | static_cast<uint32_t>(packet[5]) << 16 |
+                 static_cast<uint32_t>(packet[6]) << 8 | packet[7];
+    out.length = static_cast<uint16_t>(packet[8] << 8 | packet[9]);
+    out.data = packet + header;
+    return size >= header + out.length;
+  }
+
+  bool Receiver::receive(const uint8_t *packet, size_t size)
+  {
+    Packet parsed;
+    if (!parse(packet, size, parsed))
+    {
+      return false;
+    }
+
+    // Sequences run 1-15 and wrap past 0, which means "not used".
+    if (parsed.sequence && lastSequence)
+    {
+      uint8_t expected = lastSequence == 15 ? 1 : lastSequence + 1;
+      lostCount += (parsed.sequence + 15 - expected) % 15;
+    }
+    lastSequence = parsed.sequence;
+
+    if (parsed.offset < Capacity)
+    {
+      uint16_t length = parsed.length < Capacity - parsed.offset ? parsed.length : Capacity - parsed.offset;
+      memcpy(frame + parsed.offset, parsed.data, length);
+      uint16_t end = static_cast<uint16_t>(parsed.offset + length);
+      assembled = end > assembled ? end : assembled;
+    }
+    if (!parsed.push)
+    {
+      return false;
+    }
+
+    frameLength = assembled;
+    assembled = 0;
+    ++frameCount;
+    return true;
+  }
+}
@@ -0,0 +1,19 @@
+#include "effects.h"
+
+namespace effects
+{
+  uint16_t radarLead(uint32_t nowMs)
+  {
+    return static_cast<uint16_t>((nowMs % RadarPeriodMs) * 65536UL / RadarPeriodMs);
+  }
+
+  uint8_t radarLevel(uint16_t lead, uint16_t angle)
+  {
+    uint16_t distance = lead - angle;
+    if (distance == 0 || distance > RadarBeamWidth) // Outside [lead - width, lead)
+    {
+      return 0;
+    }
+    return lut::Brightness[255 - static_cast<uint32_t>(distance) * 255 / RadarBeamWidth];
+  }
+}
@@ -0,0 +1,345 @@
+#include "encoders.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+  uint32_t floatBits(float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+}
+
+void EncodeBuffer::put(uint8_t byte)
+{
+  if (skipped)
+  {
+    --skipped;
+    return;
+  }
+  if (overflow || used >= capacity)
+  {
+    overflow = true;
+    return;
+  }
+  data[used++] = byte;
+}
+
+// Fills the buffer as far as it goes before reporting overflow, so a
+// window through a long piece ends exactly at capacity.
+void EncodeBuffer::put(const void *bytes, size_t count)
+{
+  const uint8_t *source = static_cast<const uint8_t *>(bytes);
+  size_t dropped = count < skipped ? count : skipped;
+  skipped -= dropped;
+  source += dropped;
+  count -= dropped;
+  if (overflow || !count)
+  {
+    return;
+  }
+  if (count > capacity - used)
+  {
+    memcpy(data + used, source, capacity - used);
+    used = capacity;
+    overflow = true;
+    return;
+  }
+  memcpy(data + used, source, count);
+  used += count;
+}
+
+// --- JSON ------------------------------------------------------------------
+
+void JsonWriter::separate()
+{
+  if (afterKey)
+  {
+    afterKey = false;
+    return;
+  }
+  if (depth && !first[depth - 1])
+  {
+    put(',');
+  }
+  if (depth)
+  {
+    first[depth - 1] = false;
+  }
+}
+
+// Past MaxDepth there is no comma state to keep, so the payload fails.
+void JsonWriter::open(char bracket)
+{
+  if (depth >= MaxDepth)
+  {
+    fail();
+    return;
+  }
+  separate();
+  put(bracket);
+  first[depth++] = true;
+}
+
+void JsonWriter::close(char bracket)
+{
+  put(bracket);
+  if (depth)
+  {
+    --depth;
+  }
+}
+
+void JsonWriter::beginMap(uint8_t)
+{
+  open('{');
+}
+
+void JsonWriter::beginArray(uint16_t)
+{
+  open('[');
+}
+
+void JsonWriter::key(const char *name)
+{
+  text(name);
+  put(':');
+  afterKey = true;
+}
+
+void JsonWriter::text(const char *value)
+{
+  separate();
+  put('"');
+  for (const char *c = value; *c; ++c)
+  {
+    uint8_t byte = static_cast<uint8_t>(*c);
+    if (byte == '"' || byte == '\\')
+    {
+      put('\\');
+      put(byte);
+    }
+    else if (byte < 0x20)
+    {
+      char escaped[7];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+      put(escaped, 6);
+    }
+    else
+    {
+      put(byte);
+    }
+  }
+  put('"');
+}
+
+void JsonWriter::unsignedInt(uint32_t value)
+{
+  separate();
+  char digits[11];
+  int count = snprintf(digits, sizeof(digits), "%lu", static_cast<unsigned long>(value));
+  put(digits, count);
+}
+
+void JsonWriter::integer(int32_t value)
+{
+  separate();
+  char digits[12];
+  int count = snprintf(digits, sizeof(digits), "%ld", static_cast<long>(value));
+  put(digits, count);
+}
+
+void JsonWriter::boolean(bool value)
+{
+  separate();
+  put(value ? "true" : "false", value ? 4 : 5);
+}
+
+void JsonWriter::decimal(float value)
+{
+  separate();
+  char digits[24];
+  int count = snprintf(digits, sizeof(digits), "%.2f", static_cast<double>(value));
+  put(digits, count > 0 && count < static_cast<int>(sizeof(digits)) ? count : 0);
+}
+
+// --- CBOR ------------------------------------------------------------------
+
+void CborWriter::head(uint8_t majorType, uint32_t value)
+{
+  uint8_t major = majorType << 5;
+  if (value < 24)
+  {
+    put(major | value);
+  }
+  else if (value <= 0xFF)
+  {
+    put(major | 24);
+    put(static_cast<uint8_t>(value));
+  }
+  else if (value <= 0xFFFF)
+  {
+    put(major | 25);
+    put(static_cast<uint8_t>(value >> 8));
+    put(static_cast<uint8_t>(value));
+  }
+  else
+  {
+    put(major | 26);
+    put(static_cast<uint8_t>(value >> 24));
+    put(static_cast<uint8_t>(value >> 16));
+    put(static_cast<uint8_t>(value >> 8));
+    put(static_cast<uint8_t>(value));
+  }
+}
+
+void CborWriter::integer(int32_t value)
+{
+  if (value >= 0)
+  {
+    head(0, static_cast<uint32_t>(value));
+  }
+  else
+  {
+    head(1, static_cast<uint32_t>(-1 - value)); // Major type 1 stores -1 - n
+  }
+}
+
+void CborWriter::text(const char *value)
+{
+  size_t length = strlen(value);
+  head(3, static_cast<uint32_t>(length));
+  put(value, length);
+}
+
+void CborWriter::decimal(float value)
+{
+  uint32_t bits = floatBits(value);
+  put(0xFA); // Single-precision float
+  put(static_cast<uint8_t>(bits >> 24));
+  put(static_cast<uint8_t>(bits >> 16));
+  put(static_cast<uint8_t>(bits >> 8));
+  put(static_cast<uint8_t>(bits));
+}
+
+// --- MessagePack -------------------------------------------------------------
+
+void MsgPackWriter::beginMap(uint8_t entries)
+{
+  if (entries < 16)
+  {
+    put(0x80 | entries);
+  }
+  else
+  {
+    put(0xDE); // map 16
+    put(0);
+    put(entries);
+  }
+}
+
+void MsgPackWriter::beginArray(uint16_t entries)
+{
+  if (entries < 16)
+  {
+    put(0x90 | entries);
+  }
+  else
+  {
+    put(0xDC); // array 16
+    put(static_cast<uint8_t>(entries >> 8));
+    put(static_cast<uint8_t>(entries));
+  }
+}
+
+void MsgPackWriter::text(const char *value)
+{
+  size_t length = strlen(value);
+  if (length < 32)
+  {
+    put(0xA0 | static_cast<uint8_t>(length));
+  }
+  else if (length <= 0xFF)
+  {
+    put(0xD9);
+    put(static_cast<uint8_t>(length));
+  }
+  else
+  {
+    put(0xDA);
+    put(static_cast<uint8_t>(length >> 8));
+    put(static_cast<uint8_t>(length));
+  }
+  put(value, length);
+}
+
+void MsgPackWriter::unsignedInt(uint32_t value)
+{
+  if (value < 0x80)
+  {
+    put(static_cast<uint8_t>(value));
+  }
+  else if (value <= 0xFF)
+  {
+    put(0xCC);
+    put(static_cast<uint8_t>(value));
+  }
+  else if (value <= 0xFFFF)
+  {
+    put(0xCD);
+    put(static_cast<uint8_t>(value >> 8));
+    put(static_cast<uint8_t>(value));
+  }
+  else
+  {
+    put(0xCE);
+    put(static_cast<uint8_t>(value >> 24));
+    put(static_cast<uint8_t>(value >> 16));
+    put(static_cast<uint8_t>(value >> 8));
+    put(static_cast<uint8_t>(value));
+  }
+}
+
+void MsgPackWriter::integer(int32_t value)
+{
+  if (value >= 0)
+  {
+    unsignedInt(static_cast<uint32_t>(value));
+  }
+  else if (value >= -32)
+  {
+    put(static_cast<uint8_t>(value)); // Negative fixint
+  }
+  else if (value >= -128)
+  {
+    put(0xD0);
+    put(static_cast<uint8_t>(value));
+  }
+  else if (value >= -32768)
+  {
+    put(0xD1);
+    put(static_cast<uint8_t>(value >> 8));
+    put(static_cast<uint8_t>(value));
+  }
+  else
+  {
+    put(0xD2);
+    put(static_cast<uint8_t>(value >> 24));
+    put(static_cast<uint8_t>(value >> 16));
+    put(static_cast<uint8_t>(value >> 8));
+    put(static_cast<uint8_t>(value));
+  }
+}
+
+void MsgPackWriter::decimal(float value)
+{
+  uint32_t bits = floatBits(value);
+  put(0xCA); // float 32
+  put(static_cast<uint8_t>(bits >> 24));
+  put(static_cast<uint8_t>(bits >> 16));
+  put(static_cast<uint8_t>(bits >> 8));
+  put(static_cast<uint8_t>(bits));
+}
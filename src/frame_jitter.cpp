@@ -0,0 +1,46 @@
+#include "frame_jitter.h"
+
+#include <string.h>
+
+bool JitterMeter::record(uint32_t deviationUs)
+{
+  uint32_t bucket = deviationUs / BucketUs;
+  ++buckets[bucket < BucketCount ? bucket : BucketCount - 1];
+  sumUs += deviationUs;
+  if (deviationUs > maxUs)
+  {
+    maxUs = deviationUs;
+  }
+  if (++count < WindowFrames)
+  {
+    return false;
+  }
+
+  // Upper edge of the bucket holding the 99th percentile sample.
+  uint16_t threshold = count - count / 100;
+  uint16_t seen = 0;
+  uint8_t index = 0;
+  for (; index < BucketCount - 1; ++index)
+  {
+    seen += buckets[index];
+    if (seen >= threshold)
+    {
+      break;
+    }
+  }
+
+  result.p99Us = index == BucketCount - 1 ? maxUs : (index + 1) * static_cast<uint32_t>(BucketUs);
+  result.maxUs = maxUs;
+  result.meanUs = sumUs / count;
+  result.frames = count;
+  reset();
+  return true;
+}
+
+void JitterMeter::reset()
+{
+  memset(buckets, 0, sizeof(buckets));
+  count = 0;
+  sumUs = 0;
+  maxUs = 0;
+}
@@ -0,0 +1,541 @@
+#include "gif_player.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+  constexpr float TwoPi = 2.0f * static_cast<float>(M_PI);
+  constexpr uint16_t NoCode = 0xFFFF;
+
+  // Interlaced images send rows in four passes.
+  constexpr uint8_t PassStart[] = {0, 4, 2, 1};
+  constexpr uint8_t PassStep[] = {8, 8, 4, 2};
+
+  lut::Rgb8 blend(const lut::Rgb8 &c00, const lut::Rgb8 &c10, const lut::Rgb8 &c01, const lut::Rgb8 &c11,
+                  uint8_t fx, uint8_t fy)
+  {
+    auto mix = [fx, fy](uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+      uint32_t top = a * (256u - fx) + b * fx;
+      uint32_t bottom = c * (256u - fx) + d * fx;
+      return static_cast<uint8_t>((top * (256u - fy) + bottom * fy) >> 16);
+    };
+    return {mix(c00.r, c10.r, c01.r, c11.r), mix(c00.g, c10.g, c01.g, c11.g), mix(c00.b, c10.b, c01.b, c11.b)};
+  }
+
+  uint16_t littleEndian(const uint8_t *bytes)
+  {
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+  }
+}
+
+bool GifPlayer::open(GifReader &reader)
+{
+  source = &reader;
+  inputLength = inputOffset = 0;
+  consumed = 0;
+
+  uint8_t header[13];
+  if (!readBytes(header, sizeof(header)) || memcmp(header, "GIF8", 4) != 0 ||
+      (header[4] != '7' && header[4] != '9') || header[5] != 'a')
+  {
+    return fail();
+  }
+
+  canvasWidth = littleEndian(header + 6);
+  canvasHeight = littleEndian(header + 8);
+  if (!canvasWidth || !canvasHeight || canvasWidth > MaxSide || canvasHeight > MaxSide)
+  {
+    canvasWidth = canvasHeight = 0;
+    return fail();
+  }
+
+  hasGlobalPalette = header[10] & 0x80;
+  memset(globalPalette, 0, sizeof(globalPalette));
+  if (hasGlobalPalette && !readPalette(globalPalette, header[10]))
+  {
+    return fail();
+  }
+
+  firstFrameAt = consumed;
+  framesSinceRewind = false;
+  placePoints();
+  resetCanvas();
+  return true;
+}
+
+void GifPlayer::bind(const SpiralGeometry &geometry)
+{
+  positionCount = geometry.count();
+  for (uint16_t pixel = 0; pixel < positionCount; ++pixel)
+  {
+    positions[pixel] = geometry.point(pixel);
+  }
+  placePoints();
+  resetCanvas();
+}
+
+// Same fit as SpiralImage: the shorter side spans the spiral, centred.
+// Each pixel gets the four texels around it, then every point is bucketed
+// by row and sorted by column so decoding can walk them in stream order.
+void GifPlayer::placePoints()
+{
+  if (!canvasWidth)
+  {
+    return;
+  }
+
+  const float centreX = (canvasWidth - 1) / 2.0f;
+  const float centreY = (canvasHeight - 1) / 2.0f;
+  const float half = ((canvasWidth < canvasHeight ? canvasWidth : canvasHeight) - 1) / 2.0f;
+
+  for (uint16_t pixel = 0; pixel < positionCount; ++pixel)
+  {
+    float radius = positions[pixel].radius / 255.0f;
+    float theta = TwoPi * positions[pixel].angle / 65536.0f;
+    float x = centreX + radius * cosf(theta) * half;
+    float y = centreY - radius * sinf(theta) * half;
+    x = x < 0.0f ? 0.0f : x;
+    y = y < 0.0f ? 0.0f : y;
+
+    uint16_t x0 = static_cast<uint16_t>(x);
+    uint16_t y0 = static_cast<uint16_t>(y);
+    x0 = x0 < canvasWidth ? x0 : canvasWidth - 1;
+    y0 = y0 < canvasHeight ? y0 : canvasHeight - 1;
+    uint16_t x1 = x0 + 1 < canvasWidth ? x0 + 1 : x0;
+    uint16_t y1 = y0 + 1 < canvasHeight ? y0 + 1 : y0;
+
+    Point *corner = points + pixel * 4;
+    corner[0] = {x0, y0};
+    corner[1] = {x1, y0};
+    corner[2] = {x0, y1};
+    corner[3] = {x1, y1};
+    weights[pixel] = {static_cast<uint8_t>((x - x0) * 255.0f), static_cast<uint8_t>((y - y0) * 255.0f)};
+  }
+
+  const uint16_t total = positionCount * 4;
+  memset(rowStart, 0, sizeof(rowStart));
+  for (uint16_t index = 0; index < total; ++index)
+  {
+    ++rowStart[points[index].y + 1];
+  }
+  for (uint16_t y = 0; y < canvasHeight; ++y)
+  {
+    rowStart[y + 1] += rowStart[y];
+  }
+
+  memcpy(rowFill, rowStart, sizeof(uint16_t) * canvasHeight);
+  for (uint16_t index = 0; index < total; ++index)
+  {
+    order[rowFill[points[index].y]++] = index;
+  }
+
+  // Rows hold a handful of points each.
+  for (uint16_t y = 0; y < canvasHeight; ++y)
+  {
+    for (uint16_t i = rowStart[y] + 1; i < rowStart[y + 1]; ++i)
+    {
+      uint16_t moving = order[i];
+      uint16_t j = i;
+      for (; j > rowStart[y] && points[order[j - 1]].x > points[moving].x; --j)
+      {
+        order[j] = order[j - 1];
+      }
+      order[j] = moving;
+    }
+  }
+}
+
+void GifPlayer::resetCanvas()
+{
+  memset(canvas, 0, sizeof(canvas));
+  memset(saved, 0, sizeof(saved));
+  lastDisposal = Disposal::Keep;
+}
+
+lut::Rgb8 GifPlayer::sample(uint16_t logical) const
+{
+  const lut::Rgb8 *corner = canvas + logical * 4;
+  return blend(corner[0], corner[1], corner[2], corner[3], weights[logical].fx, weights[logical].fy);
+}
+
+bool GifPlayer::decodeFrame()
+{
+  if (!source)
+  {
+    return false;
+  }
+
+  disposePrevious();
+  delayMs = 100;
+  transparent = false;
+  disposal = Disposal::Keep;
+
+  for (;;)
+  {
+    uint8_t introducer;
+    if (!readByte(introducer))
+    {
+      return fail();
+    }
+
+    if (introducer == 0x2C)
+    {
+      framesSinceRewind = true;
+      return decodeImage() || fail();
+    }
+
+    if (introducer == 0x21)
+    {
+      uint8_t label;
+      if (!readByte(label) || !(label == 0xF9 ? readGraphicControl() : skipSubBlocks()))
+      {
+        return fail();
+      }
+    }
+    else if (introducer != 0x3B || !framesSinceRewind || !rewind())
+    {
+      return fail(); // Unknown block, or a file with no frames
+    }
+  }
+}
+
+// Trailer reached: loop back to the first frame on a blank canvas.
+bool GifPlayer::rewind()
+{
+  if (!source->seek(firstFrameAt))
+  {
+    return false;
+  }
+  inputLength = inputOffset = 0;
+  consumed = firstFrameAt;
+  framesSinceRewind = false;
+  resetCanvas();
+  return true;
+}
+
+bool GifPlayer::readGraphicControl()
+{
+  uint8_t control[5];
+  if (!readBytes(control, sizeof(control)) || control[0] < 4)
+  {
+    return false;
+  }
+
+  uint8_t method = (control[1] >> 2) & 0x07;
+  disposal = method == 2 ? Disposal::Background : (method == 3 ? Disposal::Previous : Disposal::Keep);
+  transparent = control[1] & 0x01;
+  transparentIndex = control[4];
+
+  // Browsers treat delays under 20 ms as 100 ms; so do we.
+  uint16_t delay = littleEndian(control + 2);
+  delayMs = delay < 2 ? 100 : delay * 10;
+
+  return readBytes(block, control[0] - 4) && skipSubBlocks();
+}
+
+bool GifPlayer::decodeImage()
+{
+  uint8_t descriptor[9];
+  if (!readBytes(descriptor, sizeof(descriptor)))
+  {
+    return false;
+  }
+  frameLeft = littleEndian(descriptor);
+  frameTop = littleEndian(descriptor + 2);
+  frameWidth = littleEndian(descriptor + 4);
+  frameHeight = littleEndian(descriptor + 6);
+  interlaced = descriptor[8] & 0x40;
+
+  palette = globalPalette;
+  if (descriptor[8] & 0x80)
+  {
+    if (!readPalette(localPalette, descriptor[8]))
+    {
+      return false;
+    }
+    palette = localPalette;
+  }
+
+  uint8_t minimumCodeSize;
+  if (!readByte(minimumCodeSize) || minimumCodeSize < 1 || minimumCodeSize > 11)
+  {
+    return false;
+  }
+
+  if (disposal == Disposal::Previous)
+  {
+    memcpy(saved, canvas, sizeof(canvas));
+  }
+
+  pass = 0;
+  row = 0;
+  column = 0;
+  pixelsLeft = static_cast<uint32_t>(frameWidth) * frameHeight;
+  startRow();
+
+  blockLength = blockOffset = 0;
+  blocksEnded = false;
+  bitBuffer = 0;
+  bitCount = 0;
+
+  const uint16_t clearCode = 1 << minimumCodeSize;
+  const uint16_t endCode = clearCode + 1;
+  uint16_t nextFree = clearCode + 2;
+  uint16_t previous = NoCode;
+  uint8_t first = 0;
+  codeSize = minimumCodeSize + 1;
+
+  for (uint16_t code = 0; code < clearCode; ++code)
+  {
+    suffix[code] = static_cast<uint8_t>(code);
+  }
+
+  uint16_t code;
+  while (pixelsLeft && nextCode(code))
+  {
+    if (code == clearCode)
+    {
+      codeSize = minimumCodeSize + 1;
+      nextFree = clearCode + 2;
+      previous = NoCode;
+      continue;
+    }
+    if (code == endCode)
+    {
+      break;
+    }
+
+    if (previous == NoCode)
+    {
+      if (code >= clearCode)
+      {
+        return false;
+      }
+      first = static_cast<uint8_t>(code);
+      emit(first);
+      previous = code;
+      continue;
+    }
+
+    // Unwind the chain onto the stack; the KwKwK case repeats its first byte.
+    uint16_t depth = 0;
+    uint16_t current = code;
+    if (code == nextFree)
+    {
+      stack[depth++] = first;
+      current = previous;
+    }
+    else if (code > nextFree)
+    {
+      return false;
+    }
+    while (current >= clearCode)
+    {
+      if (depth >= MaxCodes - 1)
+      {
+        return false;
+      }
+      stack[depth++] = suffix[current];
+      current = prefix[current];
+    }
+    first = static_cast<uint8_t>(current);
+    stack[depth++] = first;
+    while (depth && pixelsLeft)
+    {
+      emit(stack[--depth]);
+    }
+
+    // A full table stays as is until the encoder sends a clear code.
+    if (nextFree < MaxCodes)
+    {
+      prefix[nextFree] = previous;
+      suffix[nextFree] = first;
+      if (++nextFree == (1u << codeSize) && codeSize < 12)
+      {
+        ++codeSize;
+      }
+    }
+    previous = code;
+  }
+
+  // Frames that end early keep the rest of the canvas, as browsers do.
+  lastDisposal = disposal;
+  lastLeft = frameLeft;
+  lastTop = frameTop;
+  lastWidth = frameWidth;
+  lastHeight = frameHeight;
+  return blocksEnded || skipSubBlocks();
+}
+
+// Pulls LZW codes LSB-first, refilling from the next data sub-block.
+bool GifPlayer::nextCode(uint16_t &code)
+{
+  while (bitCount < codeSize)
+  {
+    if (blockOffset == blockLength)
+    {
+      if (blocksEnded || !readByte(blockLength))
+      {
+        return false;
+      }
+      blockOffset = 0;
+      if (!blockLength)
+      {
+        blocksEnded = true;
+        return false;
+      }
+      if (!readBytes(block, blockLength))
+      {
+        return false;
+      }
+    }
+    bitBuffer |= static_cast<uint32_t>(block[blockOffset++]) << bitCount;
+    bitCount += 8;
+  }
+
+  code = bitBuffer & ((1u << codeSize) - 1);
+  bitBuffer >>= codeSize;
+  bitCount -= codeSize;
+  return true;
+}
+
+// One decoded pixel: stored only where sample points sit on it.
+void GifPlayer::emit(uint8_t index)
+{
+  --pixelsLeft;
+  const uint16_t x = frameLeft + column;
+  while (cursor < rowEnd && points[order[cursor]].x < x)
+  {
+    ++cursor;
+  }
+  while (cursor < rowEnd && points[order[cursor]].x == x)
+  {
+    if (!transparent || index != transparentIndex)
+    {
+      canvas[order[cursor]] = palette[index];
+    }
+    ++cursor;
+  }
+
+  if (++column == frameWidth)
+  {
+    column = 0;
+    nextRow();
+  }
+}
+
+void GifPlayer::nextRow()
+{
+  if (!interlaced)
+  {
+    ++row;
+  }
+  else
+  {
+    row += PassStep[pass];
+    while (row >= frameHeight && pass < 3)
+    {
+      row = PassStart[++pass];
+    }
+  }
+  startRow();
+}
+
+void GifPlayer::startRow()
+{
+  const uint16_t y = frameTop + row;
+  if (row >= frameHeight || y >= canvasHeight)
+  {
+    cursor = rowEnd = 0;
+    return;
+  }
+  cursor = rowStart[y];
+  rowEnd = rowStart[y + 1];
+}
+
+void GifPlayer::disposePrevious()
+{
+  if (lastDisposal == Disposal::Previous)
+  {
+    memcpy(canvas, saved, sizeof(canvas));
+  }
+  else if (lastDisposal == Disposal::Background)
+  {
+    // Background is shown as black, as most players treat it as transparent.
+    for (uint16_t index = 0; index < positionCount * 4; ++index)
+    {
+      const Point &point = points[index];
+      if (point.x >= lastLeft && point.x < lastLeft + lastWidth && point.y >= lastTop &&
+          point.y < lastTop + lastHeight)
+      {
+        canvas[index] = {0, 0, 0};
+      }
+    }
+  }
+  lastDisposal = Disposal::Keep;
+}
+
+bool GifPlayer::readPalette(lut::Rgb8 *target, uint8_t flags)
+{
+  uint16_t entries = 2u << (flags & 0x07);
+  for (uint16_t entry = 0; entry < entries; ++entry)
+  {
+    uint8_t rgb[3];
+    if (!readBytes(rgb, sizeof(rgb)))
+    {
+      return false;
+    }
+    target[entry] = {rgb[0], rgb[1], rgb[2]};
+  }
+  return true;
+}
+
+bool GifPlayer::skipSubBlocks()
+{
+  uint8_t length;
+  while (readByte(length))
+  {
+    if (!length)
+    {
+      return true;
+    }
+    if (!readBytes(block, length))
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool GifPlayer::readBytes(uint8_t *buffer, size_t length)
+{
+  while (length)
+  {
+    if (inputOffset == inputLength)
+    {
+      size_t count = source->read(input, sizeof(input));
+      if (!count)
+      {
+        return false;
+      }
+      inputLength = static_cast<uint8_t>(count);
+      inputOffset = 0;
+    }
+    size_t available = inputLength - inputOffset;
+    size_t take = available < length ? available : length;
+    memcpy(buffer, input + inputOffset, take);
+    inputOffset += take;
+    consumed += take;
+    buffer += take;
+    length -= take;
+  }
+  return true;
+}
+
+bool GifPlayer::fail()
+{
+  source = nullptr;
+  return false;
+}
@@ -0,0 +1,435 @@
+#include "json_stream.h"
+
+#include <string.h>
+
+namespace
+{
+  bool isWhitespace(uint8_t byte)
+  {
+    return byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r';
+  }
+
+  bool isNumberByte(uint8_t byte)
+  {
+    return (byte >= '0' && byte <= '9') || byte == '-' || byte == '+' || byte == '.' || byte == 'e' || byte == 'E';
+  }
+
+  int8_t hexValue(uint8_t byte)
+  {
+    if (byte >= '0' && byte <= '9')
+    {
+      return byte - '0';
+    }
+    if (byte >= 'a' && byte <= 'f')
+    {
+      return byte - 'a' + 10;
+    }
+    if (byte >= 'A' && byte <= 'F')
+    {
+      return byte - 'A' + 10;
+    }
+    return -1;
+  }
+}
+
+void JsonStreamParser::reset()
+{
+  state = Status::Parsing;
+  expect = Expect::Value;
+  lexeme = Lexeme::None;
+  offset = 0;
+  errorAt = 0;
+  level = 0;
+  tokenLength = 0;
+  readingKey = false;
+  keyTooLong = false;
+}
+
+JsonStreamParser::Status JsonStreamParser::feed(const uint8_t *data, size_t length)
+{
+  for (size_t i = 0; i < length && state == Status::Parsing; ++i, ++offset)
+  {
+    if (!step(data[i]))
+    {
+      return fail();
+    }
+  }
+  return state;
+}
+
+JsonStreamParser::Status JsonStreamParser::finish()
+{
+  if (state != Status::Parsing)
+  {
+    return state;
+  }
+  if (lexeme == Lexeme::Number && !endNumber())
+  {
+    return fail();
+  }
+  if (lexeme == Lexeme::Literal && !endLiteral())
+  {
+    return fail();
+  }
+  if (expect != Expect::End || lexeme != Lexeme::None)
+  {
+    return fail();
+  }
+  state = Status::Done;
+  return state;
+}
+
+JsonStreamParser::Status JsonStreamParser::fail()
+{
+  errorAt = offset;
+  state = Status::Error;
+  return state;
+}
+
+bool JsonStreamParser::step(uint8_t byte)
+{
+  switch (lexeme)
+  {
+  case Lexeme::String:
+    if (byte == '"')
+    {
+      return endString();
+    }
+    if (byte == '\\')
+    {
+      lexeme = Lexeme::Escape;
+      return true;
+    }
+    return byte >= 0x20 && pushToken(byte);
+
+  case Lexeme::Escape:
+    lexeme = Lexeme::String;
+    switch (byte)
+    {
+    case '"':
+    case '\\':
+    case '/':
+      return pushToken(byte);
+    case 'b':
+      return pushToken('\b');
+    case 'f':
+      return pushToken('\f');
+    case 'n':
+      return pushToken('\n');
+    case 'r':
+      return pushToken('\r');
+    case 't':
+      return pushToken('\t');
+    case 'u':
+      lexeme = Lexeme::Unicode;
+      codePoint = 0;
+      hexDigits = 0;
+      return true;
+    default:
+      return false;
+    }
+
+  case Lexeme::Unicode:
+  {
+    int8_t digit = hexValue(byte);
+    if (digit < 0)
+    {
+      return false;
+    }
+    codePoint = (codePoint << 4) | digit;
+    if (++hexDigits < 4)
+    {
+      return true;
+    }
+    lexeme = Lexeme::String;
+    return pushCodePoint(codePoint);
+  }
+
+  case Lexeme::Number:
+    if (isNumberByte(byte))
+    {
+      return pushToken(byte);
+    }
+    // The byte that ends a number belongs to the surrounding structure.
+    if (!endNumber())
+    {
+      return false;
+    }
+    break;
+
+  case Lexeme::Literal:
+    if (byte >= 'a' && byte <= 'z')
+    {
+      return pushToken(byte);
+    }
+    if (!endLiteral())
+    {
+      return false;
+    }
+    break;
+
+  case Lexeme::None:
+    break;
+  }
+
+  if (isWhitespace(byte))
+  {
+    return true;
+  }
+
+  switch (expect)
+  {
+  case Expect::Value:
+    return startValue(byte);
+
+  case Expect::KeyOrEnd:
+    if (byte == '}')
+    {
+      return closeContainer(false);
+    }
+    // fall through
+  case Expect::Key:
+    if (byte != '"')
+    {
+      return false;
+    }
+    lexeme = Lexeme::String;
+    readingKey = true;
+    keyTooLong = false;
+    tokenLength = 0;
+    return true;
+
+  case Expect::Colon:
+    if (byte != ':')
+    {
+      return false;
+    }
+    expect = Expect::Value;
+    return true;
+
+  case Expect::CommaOrEnd:
+    if (byte == ',')
+    {
+      if (arrays[level - 1])
+      {
+        ++indices[level - 1];
+        expect = Expect::Value;
+      }
+      else
+      {
+        expect = Expect::Key;
+      }
+      return true;
+    }
+    if (byte == '}' || byte == ']')
+    {
+      return closeContainer(byte == ']');
+    }
+    return false;
+
+  case Expect::End:
+    return false;
+  }
+  return false;
+}
+
+bool JsonStreamParser::startValue(uint8_t byte)
+{
+  if (byte == '{' || byte == '[')
+  {
+    if (level == MaxDepth)
+    {
+      return false;
+    }
+    bool array = byte == '[';
+    arrays[level] = array;
+    keys[level][0] = '\0';
+    indices[level] = 0;
+    ++level;
+    expect = array ? Expect::Value : Expect::KeyOrEnd;
+    return true;
+  }
+
+  // An empty array closes where its first value would start.
+  if (byte == ']' && level && arrays[level - 1] && indices[level - 1] == 0)
+  {
+    return closeContainer(true);
+  }
+
+  tokenLength = 0;
+  if (byte == '"')
+  {
+    lexeme = Lexeme::String;
+    readingKey = false;
+    return true;
+  }
+  if (byte == '-' || (byte >= '0' && byte <= '9'))
+  {
+    lexeme = Lexeme::Number;
+    return pushToken(byte);
+  }
+  if (byte == 't' || byte == 'f' || byte == 'n')
+  {
+    lexeme = Lexeme::Literal;
+    return pushToken(byte);
+  }
+  return false;
+}
+
+bool JsonStreamParser::closeContainer(bool array)
+{
+  if (!level || arrays[level - 1] != array)
+  {
+    return false;
+  }
+  --level;
+  return finishValue();
+}
+
+bool JsonStreamParser::finishValue()
+{
+  expect = level ? Expect::CommaOrEnd : Expect::End;
+  return true;
+}
+
+bool JsonStreamParser::pushToken(uint8_t byte)
+{
+  if (readingKey && tokenLength >= MaxKeyLength)
+  {
+    keyTooLong = true;
+    return true;
+  }
+  if (tokenLength >= MaxTokenLength)
+  {
+    return false;
+  }
+  token[tokenLength++] = static_cast<char>(byte);
+  return true;
+}
+
+bool JsonStreamParser::pushCodePoint(uint16_t value)
+{
+  if (value < 0x80)
+  {
+    return pushToken(static_cast<uint8_t>(value));
+  }
+  if (value < 0x800)
+  {
+    return pushToken(0xC0 | (value >> 6)) && pushToken(0x80 | (value & 0x3F));
+  }
+  // Surrogate halves are passed through as-is; config strings are ASCII.
+  return pushToken(0xE0 | (value >> 12)) && pushToken(0x80 | ((value >> 6) & 0x3F)) &&
+         pushToken(0x80 | (value & 0x3F));
+}
+
+bool JsonStreamParser::endString()
+{
+  lexeme = Lexeme::None;
+  token[tokenLength] = '\0';
+
+  if (readingKey)
+  {
+    readingKey = false;
+    memcpy(keys[level - 1], keyTooLong ? "" : token, keyTooLong ? 1 : tokenLength + 1);
+    expect = Expect::Colon;
+    return true;
+  }
+
+  JsonValue value;
+  value.type = JsonType::String;
+  value.text = token;
+  value.length = tokenLength;
+  handler.onValue(*this, value);
+  return finishValue();
+}
+
+bool JsonStreamParser::endNumber()
+{
+  lexeme = Lexeme::None;
+  token[tokenLength] = '\0';
+
+  const char *cursor = token;
+  bool negative = *cursor == '-';
+  if (negative)
+  {
+    ++cursor;
+  }
+  if (*cursor < '0' || *cursor > '9' || (cursor[0] == '0' && cursor[1] >= '0' && cursor[1] <= '9'))
+  {
+    return false;
+  }
+
+  int64_t magnitude = 0;
+  for (; *cursor >= '0' && *cursor <= '9'; ++cursor)
+  {
+    if (magnitude <= INT32_MAX)
+    {
+      magnitude = magnitude * 10 + (*cursor - '0');
+    }
+  }
+
+  if (*cursor == '.')
+  {
+    ++cursor;
+    if (*cursor < '0' || *cursor > '9')
+    {
+      return false;
+    }
+    while (*cursor >= '0' && *cursor <= '9')
+    {
+      ++cursor;
+    }
+  }
+  if (*cursor == 'e' || *cursor == 'E')
+  {
+    ++cursor;
+    if (*cursor == '+' || *cursor == '-')
+    {
+      ++cursor;
+    }
+    if (*cursor < '0' || *cursor > '9')
+    {
+      return false;
+    }
+    while (*cursor >= '0' && *cursor <= '9')
+    {
+      ++cursor;
+    }
+  }
+  if (*cursor)
+  {
+    return false;
+  }
+
+  if (magnitude > INT32_MAX)
+  {
+    magnitude = negative ? static_cast<int64_t>(INT32_MAX) + 1 : INT32_MAX;
+  }
+
+  JsonValue value;
+  value.type = JsonType::Number;
+  value.text = token;
+  value.length = tokenLength;
+  value.integer = static_cast<int32_t>(negative ? -magnitude : magnitude);
+  handler.onValue(*this, value);
+  return finishValue();
+}
+
+bool JsonStreamParser::endLiteral()
+{
+  lexeme = Lexeme::None;
+  token[tokenLength] = '\0';
+
+  JsonValue value;
+  if (strcmp(token, "true") == 0 || strcmp(token, "false") == 0)
+  {
+    value.type = JsonType::Bool;
+    value.boolean = token[0] == 't';
+  }
+  else if (strcmp(token, "null") != 0)
+  {
+    return false;
+  }
+  handler.onValue(*this, value);
+  return finishValue();
+}
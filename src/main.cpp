@@ -7,19 +7,76 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include <WiFiUdp.h>
 #include <ESPAsyncWebServer.h>
 #include <SPIFFS.h>
 #include <AsyncTCP.h>
 #include <NeoPixelBus.h>
 #include <NeoPixelAnimator.h>
+#include <memory>
+
+#include "strip_config.h"
+#include "pixel_map.h"
+#include "lookup_tables.h"
+#include "fast_random.h"
+#include "easing.h"
+#include "show_clock.h"
+#include "timeline.h"
+#include "overlay.h"
+#include "color_temperature.h"
+#include "beat_clock.h"
+#include "osc_message.h"
+#include "encoders.h"
+#include "chunked_encoder.h"
+#include "json_stream.h"
+#include "admission.h"
+#include "frame_jitter.h"
+#include "task_layout.h"
+#include "spiral_geometry.h"
+#include "effects.h"
+#include "spiral_image.h"
+#include "gif_player.h"
+#include "trails.h"
+#include "post_filter.h"
+#include "canvas_partition.h"
+#include "ddp.h"
+#include "packed_color.h"
+
+#if defined(CONFIG_ASYNC_TCP_RUNNING_CORE)
+static_assert(CONFIG_ASYNC_TCP_RUNNING_CORE == tasks::AsyncTcpCore, "async_tcp core must match task_layout.h");
+#endif
 
-constexpr uint16_t MaxPixelCount = 144; // Common LED strip size
-constexpr uint8_t PixelPin = 12;
 constexpr uint8_t AnimationChannels = 1;
 constexpr uint8_t SnakeSegmentLength = 5;
 constexpr uint16_t SnakeStepDelayMs = 80;
+constexpr uint16_t KelvinTransitionMs = 1500;
+constexpr uint16_t ControlUdpPort = 4210;
+constexpr uint8_t OverlayPacketSize = 7; // 'O', kind, r, g, b, ttl (ms, little endian)
+constexpr uint8_t TempoPacketSize = 3;   // 'B', BPM x 100 (little endian); 'T' alone is a tap
+constexpr uint16_t OscUdpPort = 8000;
+constexpr uint16_t HaloUdpPort = 4212;
+constexpr uint8_t HaloRefreshFrames = 4; // Resend unchanged edges this often, well inside HaloExchange::MaxAge
+constexpr uint32_t StreamTimeoutMs = 1000; // Local effect resumes after this long without a streamed frame
+constexpr size_t EncodeBufferSize = 768;
+constexpr uint8_t FadeBeats = 4;         // Fade length when following the beat
+constexpr uint8_t SnakeStepsPerBeat = 4;
+const char *ImagePath = "/image.rgb";        // Last uploaded image: width, height, RGB rows
+// The GIF plays from one slot while an upload fills the other; they swap
+// roles on every upload, so no file is renamed or removed while it is open.
+const char *const GifPaths[2] = {"/animation.gif", "/animation-b.gif"};
+constexpr size_t MaxGifBytes = 512 * 1024;
+constexpr uint32_t FramePeriodMs = 16;     // Render task period, ~60 fps
+constexpr uint32_t FrameBudgetUs = FramePeriodMs * 1000;
 
 uint16_t pixelCount = 12; // Default to 12 pixels
+volatile bool pixelCountPending = false; // Applied by the render task at frame start
+
+// Wiring of the spiral, listed in spiral order. Split into several runs when
+// sections are chained back and forth, e.g. {{0, 72, false}, {72, 72, true}}.
+const PixelRun ActiveRuns[] = {{0, MaxPixelCount, false}};
+// Physical indices of failed LEDs, e.g. {17, 18}; the map routes around them.
+const uint16_t *const DeadPixels = nullptr;
+constexpr uint8_t DeadPixelCount = 0;
 
 // Update with your own network credentials. Device falls back to AP mode if STA fails.
 const char *WIFI_SSID = "AndroidAPF863";
@@ -28,14 +85,126 @@ const char *AP_SSID = "NeoPixel-Control";
 const char *AP_PASSWORD = "12345678";
 
 AsyncWebServer server(80);
+AdmissionControl admission(FrameBudgetUs);
+// Encoded API bodies, one per request in flight. The response reads its body
+// straight from here, so a slot stays claimed until the connection closes.
+// Handlers, fillers and disconnects all run on the async_tcp task.
+struct BodySlot
+{
+  AsyncWebServerRequest *owner = nullptr;
+  uint8_t bytes[EncodeBufferSize];
+};
+BodySlot bodySlots[AdmissionControl::MaxInFlight];
+
+// Task placement, see task_layout.h. Profile switches are queued and applied
+// by the render task at frame start; the first frame applies the default.
+TaskHandle_t renderTaskHandle = nullptr;
+TaskProfile taskProfile = TaskProfile::Balanced;
+TaskProfile pendingTaskProfile = TaskProfile::Balanced;
+volatile bool taskProfilePending = true;
+JitterMeter frameJitter;
+JitterResult profileJitter[static_cast<size_t>(TaskProfile::Count)]; // Last window per profile
+uint32_t lastFrameUs = 0;
+
+// Serial output is deferred to the Arduino loop task (lowest priority) so a
+// full UART buffer never blocks a request handler or a frame.
+volatile bool stateLogPending = false;
+uint8_t logBuffer[EncodeBufferSize];
+WiFiUDP controlUdp;
+WiFiUDP oscUdp;
 
 NeoPixelBus<NeoGrbFeature, Neo800KbpsMethod> strip(MaxPixelCount, PixelPin);
 NeoPixelAnimator animations(AnimationChannels);
 
-boolean fadeToColor = true;
-bool snakeDirty = true;
-uint16_t snakeHead = 0;
+PixelMap pixelMap;
+SpiralGeometry geometry; // Polar positions of the logical pixels, rebuilt with pixelMap
+RgbColor frame[MaxPixelCount]; // Logical pixels, packed onto the strip by presentFrame()
+
+// Trails post effect: the last output, folded with each new frame. The decay
+// in stripState is picked up by the render task, which clears stale history.
+RgbColor trailFrame[MaxPixelCount];
+uint8_t trailDecay = 0;
+bool trailsFading = false;
+
+// Convolution post chain, applied after trails into its own buffer. The spec
+// is validated on async_tcp and staged here; the render task builds it.
+PostChain postChain;
+RgbColor postFrame[MaxPixelCount];
+char pendingPost[PostChain::MaxSpecLength + 1] = "off";
+uint8_t pendingPostStrength = 128;
+volatile bool postPending = false;
+uint32_t postUs = 0; // Last pass over the whole chain
+
+// Partitioned canvas, see canvas_partition.h. The render task broadcasts
+// this node's edges; the network task queues one packet per neighbour,
+// which the render task takes at its next frame.
+HaloExchange halos;
+WiFiUDP haloUdp;     // Receives, on the network task
+WiFiUDP haloSendUdp; // Sends, on the render task
+uint8_t pendingHalo[2][HaloExchange::PacketSize]; // Left, right
+volatile bool haloPending[2] = {};
+uint16_t haloSequence = 0;
+uint8_t haloIdleFrames = 0;
+
+// Thin-client mode: DDP frames from a host renderer stand in for the local
+// effect. The network task assembles them and hands each finished frame to
+// the render task, which goes back to the local effect when they stop.
+WiFiUDP ddpUdp;
+ddp::Receiver streamReceiver; // Network task only
+uint8_t ddpPacket[ddp::HeaderSize + ddp::TimecodeSize + ddp::MaxData];
+uint8_t pendingStream[ddp::Receiver::Capacity];
+uint16_t pendingStreamLength = 0;
+volatile bool streamPending = false;
+bool streaming = false;
+unsigned long lastStreamMs = 0;
+uint32_t streamFrames = 0;    // Shown
+uint32_t streamLate = 0;      // Arrived before the last one was shown, dropped
+uint32_t streamFallbacks = 0; // Times the stream stopped
+
+uint16_t snakeHead = 0; // In canvas pixels
 unsigned long lastSnakeStepMs = 0;
+uint32_t lastSnakeClockStep = 0;
+
+effects::Radar radar;
+
+// Image uploads stream into the image's upload buffer on async_tcp; the
+// render task swaps them in (polar resample) at frame start and the loop
+// task saves them. A new upload waits until both are done. Scroll and spin
+// are staged the same way and taken over with the image, or on their own
+// when only they change, so motion and texture switch on one frame.
+SpiralImage image;
+AsyncWebServerRequest *imageUploadOwner = nullptr;
+bool imageUploadFailed = false;
+volatile bool imageFinishPending = false;
+volatile bool imageSavePending = false;
+int16_t pendingImageScroll = 0;
+uint16_t pendingImageSpinMs = 0;
+volatile bool imageMotionPending = false;
+
+// Adapts a SPIFFS file to the GIF player.
+class FileGifReader : public GifReader
+{
+public:
+  File file;
+
+  size_t read(uint8_t *buffer, size_t length) override { return file.read(buffer, length); }
+  bool seek(uint32_t position) override { return file.seek(position); }
+};
+
+// The GIF plays straight from SPIFFS on the render task. Uploads stream to
+// the free slot on async_tcp; the render task only closes the old slot and
+// opens the new one at frame start, and the loop removes the old file.
+GifPlayer gif;
+FileGifReader gifFile;
+uint8_t gifSlot = 0; // Slot being played; the render task switches it
+File gifUpload;
+AsyncWebServerRequest *gifUploadOwner = nullptr;
+bool gifUploadFailed = false;
+volatile bool gifReplacePending = false;
+volatile bool gifRemovePending = false; // Old slot still to be removed
+unsigned long gifFrameDueMs = 0;
+uint32_t gifDecodeUs = 0; // Last frame's decode time, and the worst since loading
+uint32_t gifMaxDecodeUs = 0;
 
 struct FadeChannelState
 {
@@ -44,50 +213,332 @@ struct FadeChannelState
 };
 
 FadeChannelState fadeChannels[AnimationChannels];
+FastRandom fadeRandom; // Render task only; seeds are queued
+uint32_t pendingSeed = 0;
+volatile bool seedPending = false;
+
+ShowClock showClock; // Render task only; jumps are queued as a new origin
+uint32_t pendingShowOriginMs = 0; // Local time at which the show reads 0
+volatile bool showJumpPending = false;
+TimelinePlayer showPlayer;
+uint8_t showValues[static_cast<uint8_t>(TimelineParam::Count)];
+RgbColor lastShowColor;
+bool showFramePending = true;
+
+// Warm white eases from the temperature on screen to the new target. The
+// fade is render task only; a new target is queued and starts at frame start.
+uint16_t kelvinFrom = 2700;
+uint16_t kelvinTo = 2700;
+unsigned long kelvinChangedMs = 0;
+uint16_t pendingKelvin = 2700;
+volatile bool kelvinPending = false;
+
+// HTTP overlay triggers arrive on the network task; the render task picks them up
+// at the start of the next frame.
+Overlay overlay;
+OverlayRequest pendingOverlay;
+volatile bool overlayPending = false;
+uint32_t overlayTriggerUs = 0;
+bool overlayLatencyPending = false;
+uint32_t overlayLatencyUs = 0; // Trigger to strip update, last overlay
+
+// Tempo changes are queued the same way; taps keep their arrival time.
+BeatClock beatClock;
+volatile bool tapPending = false;
+uint32_t pendingTapMs = 0;
+volatile bool bpmPending = false;
+uint16_t pendingCentiBpm = 0;
+uint32_t lastSnakeBeatStep = 0;
+
+enum class WireFormat
+{
+  Json,
+  Cbor,
+  MsgPack
+};
 
 enum class EffectMode
 {
   Fade,
   Solid,
   Snake,
+  Rainbow,
+  Show,
+  Warm,
+  Radar,
+  Image,
+  Gif,
   Off
 };
 
+// An effect renders into `frame`. Static effects (animated == false) depend
+// only on parameters, so they are rendered once and the cached frame is kept
+// until a parameter changes. Animated effects return whether they changed the
+// frame this pass, so unchanged frames are not re-sent. Effects with
+// position state rescale it in `resize` when the strip length changes live.
+struct EffectDefinition
+{
+  const char *name;
+  bool animated;
+  void (*start)();
+  bool (*render)();
+  void (*resize)(uint16_t oldCount, uint16_t newCount);
+};
+
+// How the rendered pixels are laid onto the spiral; see PixelMapConfig.
+struct StripLayout
+{
+  uint16_t offset = 0;
+  bool reverse = false;
+  bool mirror = false;
+  uint8_t group = 1;
+  uint16_t renderLength = 0;
+  bool interpolate = false;
+};
+
 struct StripState
 {
   EffectMode effect = EffectMode::Fade;
   RgbColor solidColor = RgbColor(255, 80, 10);
   uint8_t brightness = 160;
+  Easing fadeEasing = Easing::InOutSine;
+  uint8_t showIndex = 0; // Into BuiltInShows
+  uint16_t kelvin = 2700;
+  bool beatSync = false; // Fade, snake and radar follow the BPM clock while it runs
+  int16_t imageScroll = 0;  // Texels per second; negative scrolls the other way
+  uint16_t imageSpinMs = 0; // One turn of the image; 0 holds it still (scroll applies)
+  uint8_t trails = 0;       // Trail decay per frame, 0 (off) to 255 (longest)
+  char post[PostChain::MaxSpecLength + 1] = "off";
+  uint8_t postStrength = 128; // Glow and sharpen amount
+  uint8_t node = 0;           // This controller's slice of a shared canvas
+  uint8_t nodes = 1;
+  StripLayout layout;
 };
 
 StripState stripState;
-bool solidDirty = true;
-bool offDirty = true;
+
+// Layout changes are staged by async_tcp and applied with the pixel map by
+// the render task at frame start; rebuildPixelMap() reads appliedLayout.
+StripLayout pendingLayout;
+volatile bool layoutPending = false;
+StripLayout appliedLayout;
+
+// Settings accepted by /api/control, as query parameters or JSON body keys.
+enum class ControlField : uint8_t
+{
+  Mode,
+  Brightness,
+  PixelCount,
+  Easing,
+  Seed,
+  Kelvin,
+  BeatSync,
+  Show,
+  ShowTime,
+  Offset,
+  Reverse,
+  Mirror,
+  Group,
+  Length,
+  Smooth,
+  Trails,
+  Post,
+  PostStrength,
+  Node,
+  Nodes,
+  Red,
+  Green,
+  Blue,
+  Count
+};
+
+const char *const ControlFieldNames[] = {
+    "mode", "brightness", "count", "easing", "seed", "kelvin", "beatsync", "show", "showtime",
+    "offset", "reverse", "mirror", "group", "length", "smooth", "trails", "post", "poststrength", "node", "nodes",
+    "r", "g", "b"};
+static_assert(sizeof(ControlFieldNames) / sizeof(ControlFieldNames[0]) == static_cast<size_t>(ControlField::Count),
+              "ControlFieldNames must match ControlField");
+
+// One control request, filled field by field before anything is applied.
+struct ControlUpdate
+{
+  static constexpr size_t MaxNameLength = PostChain::MaxSpecLength + 1;
+
+  uint32_t present = 0;
+  uint32_t invalid = 0; // Fields whose value was not a number or true/false
+  int32_t values[static_cast<size_t>(ControlField::Count)] = {}; // seed and showtime hold uint32 bits
+  char mode[MaxNameLength] = {};
+  char easing[MaxNameLength] = {};
+  char show[MaxNameLength] = {};
+  char post[MaxNameLength] = {};
+
+  bool has(ControlField field) const { return present & (1u << static_cast<uint8_t>(field)); }
+  int32_t value(ControlField field) const { return values[static_cast<size_t>(field)]; }
+};
+
+// Maps streamed /api/control JSON straight onto a ControlUpdate. Accepts the
+// flat parameter names as well as the shape of /api/state ("beatSync",
+// "color": {"r", "g", "b"}); unknown keys are ignored.
+class ControlJsonHandler : public JsonHandler
+{
+public:
+  ControlUpdate update;
+
+  void onValue(const JsonStreamParser &parser, const JsonValue &value) override;
+};
+
+ControlJsonHandler controlBody;
+JsonStreamParser controlParser(controlBody);
+AsyncWebServerRequest *controlBodyOwner = nullptr; // Request whose body is being parsed
+bool frameDirty = true;     // Parameters changed; static effects must re-render
+volatile bool restartPending = true; // Effect changed or needs to start over
+// The effect the render task started; stripState.effect is the one asked
+// for, taken over at the restart it queues.
+EffectMode runningEffect = EffectMode::Off;
 bool wifiConnected = false;
 
 void SetRandomSeed();
 void BlendAnimUpdate(const AnimationParam &param);
-void FadeInFadeOutRinseRepeat(float luminance);
+void FadeInFadeOutRinseRepeat(uint8_t level);
 void ensureEffectIsRunning();
 void initSPIFFS();
 void initNetworking();
 void configureRoutes();
+void startTasks();
+void startNetworkTask(const TaskPlacement &placement);
+void renderTask(void *parameter);
+void networkTask(void *parameter);
+void queueTaskProfile(TaskProfile profile);
+void applyPendingTaskProfile();
+void handleTasksRequest(AsyncWebServerRequest *request);
+void handleImageRequest(AsyncWebServerRequest *request);
+void handleImageUpload(AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total);
+void handleImageUploadRequest(AsyncWebServerRequest *request);
+template <typename Writer>
+void writeImage(Writer &writer);
+void applyPendingImage();
+bool stageImageMotion(AsyncWebServerRequest *request);
+void loadImage();
+void saveImage();
+void handleGifRequest(AsyncWebServerRequest *request);
+void handleGifUpload(AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total);
+void handleGifUploadRequest(AsyncWebServerRequest *request);
+template <typename Writer>
+void writeGif(Writer &writer);
+void applyPendingGif();
+void removeOldGif();
+void chooseGifSlot();
+bool openGif();
+template <typename Writer>
+void writeTasks(Writer &writer);
+void flushLog();
+RequestClass classifyRequest(const String &url);
 void handleControlRequest(AsyncWebServerRequest *request);
-String buildStateJson();
-String modeToString(EffectMode mode);
+void handleControlBody(AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total);
+void handleControlBodyRequest(AsyncWebServerRequest *request);
+bool setControlField(ControlUpdate &update, const char *name, const char *text, bool numberLiteral = false);
+bool parseControlValue(ControlField field, const char *text, bool numberLiteral, int32_t &value);
+bool rejectInvalidControl(AsyncWebServerRequest *request, const ControlUpdate &update);
+bool applyControlUpdate(const ControlUpdate &update);
+void respondToControl(AsyncWebServerRequest *request, bool changed);
+void handleOverlayRequest(AsyncWebServerRequest *request);
+void queueOverlay(const OverlayRequest &request);
+void handleTempoRequest(AsyncWebServerRequest *request);
+void queueTap();
+void queueBpm(uint16_t centiBpm);
+void applyPendingTempo();
+void pollControlUdp();
+void pollOscUdp();
+void pollHaloUdp();
+void pollDdpUdp();
+bool applyPendingStream(unsigned long now);
+template <typename Writer>
+void writeStream(Writer &writer);
+template <typename Writer>
+void writeTempo(Writer &writer);
+template <typename Writer>
+void writeState(Writer &writer);
+template <typename Body>
+void sendBody(AsyncWebServerRequest *request, Body body);
+template <typename Source>
+void sendChunked(AsyncWebServerRequest *request, Source source);
+uint8_t *claimBodySlot(AsyncWebServerRequest *request);
+void releaseBodySlot(AsyncWebServerRequest *request);
+template <typename Writer>
+bool writeCatalogStep(Writer &writer, uint16_t step);
+void logState();
 bool applyModeFromString(const String &value);
 bool setSolidColor(uint8_t r, uint8_t g, uint8_t b);
 bool setBrightness(uint8_t value);
 bool setPixelCount(uint16_t count);
-float brightnessScale();
-float brightnessToLuminance();
+void applyPixelCount();
+bool setEffectSeed(uint32_t seed);
+uint32_t effectSeed();
+void applyPendingSeed();
+bool setFadeEasing(const String &name);
+bool setLayout(const StripLayout &layout);
+bool selectShow(const String &name);
+bool setShowPosition(uint32_t positionMs);
+uint32_t showPosition(unsigned long now);
+void queueShowOrigin(uint32_t originMs);
+void applyPendingShowJump();
+bool setKelvin(uint16_t value);
+bool setTrails(uint8_t decay);
+bool setPostChain(const char *spec, uint8_t strength);
+bool setCanvasSlice(uint8_t node, uint8_t nodes);
+CanvasSlice canvasSlice();
+bool exchangeHalos(const CanvasSlice &slice, const RgbColor *pixels, bool edgesChanged);
+uint16_t displayedKelvin(unsigned long now);
+void applyPendingKelvin();
+void applyPendingLayout();
+void rebuildPixelMap();
+void presentFrame();
+uint8_t brightnessLevel();
+uint8_t fadeLevel();
 RgbColor applyBrightness(const RgbColor &color);
-void turnStripOff();
-void applySolidColor();
+uint32_t packColor(const RgbColor &color);
+RgbColor unpackColor(uint32_t color);
+void invalidateFrame();
+void restartEffect();
 void writeColorToActivePixels(const RgbColor &color);
-RgbColor scaleColor(const RgbColor &color, float scale);
-void resetSnakeEffect();
-void runSnakeEffect();
+RgbColor scaleColor(const RgbColor &color, uint16_t factor);
+bool renderFade();
+bool renderSolid();
+void startSnake();
+bool renderSnake();
+void resizeSnake(uint16_t oldCount, uint16_t newCount);
+bool renderRainbow();
+void startShow();
+bool renderShow();
+bool renderWarm();
+void startRadar();
+bool renderRadar();
+void resizeRadar(uint16_t oldCount, uint16_t newCount);
+bool renderImage();
+void startGif();
+bool renderGif();
+bool renderOff();
+
+// Indexed by EffectMode.
+const EffectDefinition Effects[] = {
+    {"fade", true, nullptr, renderFade, nullptr},
+    {"solid", false, nullptr, renderSolid, nullptr},
+    {"snake", true, startSnake, renderSnake, resizeSnake},
+    {"rainbow", false, nullptr, renderRainbow, nullptr},
+    {"show", true, startShow, renderShow, nullptr},
+    {"warm", false, nullptr, renderWarm, nullptr},
+    {"radar", true, startRadar, renderRadar, resizeRadar},
+    {"image", true, nullptr, renderImage, nullptr},
+    {"gif", true, startGif, renderGif, nullptr},
+    {"off", false, nullptr, renderOff, nullptr},
+};
+static_assert(sizeof(Effects) / sizeof(Effects[0]) == static_cast<size_t>(EffectMode::Off) + 1,
+              "one effect definition per EffectMode");
+
+const EffectDefinition &effectFor(EffectMode mode)
+{
+  return Effects[static_cast<size_t>(mode)];
+}
 
 void setup()
 {
@@ -96,6 +547,10 @@ void setup()
 
   initSPIFFS();
 
+  rebuildPixelMap();
+  loadImage();
+  chooseGifSlot();
+  openGif();
   strip.Begin();
   strip.Show();
   SetRandomSeed();
@@ -103,14 +558,125 @@ void setup()
   initNetworking();
   configureRoutes();
   server.begin();
+  controlUdp.begin(ControlUdpPort);
+  oscUdp.begin(OscUdpPort);
+  haloUdp.begin(HaloUdpPort);
+  ddpUdp.begin(ddp::Port);
+  startTasks();
 
   Serial.println("NeoPixel controller ready.");
 }
 
+// Rendering and UDP run in their own tasks; the Arduino loop only logs.
 void loop()
 {
-  ensureEffectIsRunning();
-  delay(1);
+  flushLog();
+  if (imageSavePending)
+  {
+    imageSavePending = false;
+    saveImage();
+  }
+  if (gifRemovePending)
+  {
+    removeOldGif();
+  }
+  delay(20);
+}
+
+void startTasks()
+{
+  const TaskPlacement &placement = tasks::placement(taskProfile);
+  xTaskCreatePinnedToCore(renderTask, "render", tasks::RenderStackSize, nullptr, placement.renderPriority,
+                          &renderTaskHandle, tasks::RenderCore);
+  startNetworkTask(placement);
+}
+
+void startNetworkTask(const TaskPlacement &placement)
+{
+  xTaskCreatePinnedToCore(networkTask, "udp", tasks::NetworkStackSize, nullptr, placement.networkPriority, nullptr,
+                          placement.networkCore);
+}
+
+// Fixed-period frames. Jitter is each frame's distance from the nominal
+// period; frames that start late also count against admission slack.
+void renderTask(void *)
+{
+  TickType_t wake = xTaskGetTickCount();
+  for (;;)
+  {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(FramePeriodMs));
+    applyPendingTaskProfile();
+
+    uint32_t startUs = micros();
+    uint32_t lateUs = 0;
+    if (lastFrameUs)
+    {
+      uint32_t intervalUs = startUs - lastFrameUs;
+      lateUs = intervalUs > FrameBudgetUs ? intervalUs - FrameBudgetUs : 0;
+      if (frameJitter.record(lateUs ? lateUs : FrameBudgetUs - intervalUs))
+      {
+        profileJitter[static_cast<size_t>(taskProfile)] = frameJitter.last();
+      }
+    }
+    lastFrameUs = startUs;
+
+    ensureEffectIsRunning();
+    admission.recordFrame(micros() - startUs + lateUs);
+  }
+}
+
+// Follows the task profile itself: a core change starts a replacement and
+// ends this task between polls, so it never goes while holding a socket.
+void networkTask(void *)
+{
+  for (;;)
+  {
+    const TaskPlacement &placement = tasks::placement(taskProfile);
+    if (placement.networkCore != xPortGetCoreID())
+    {
+      startNetworkTask(placement);
+      vTaskDelete(nullptr);
+    }
+    if (uxTaskPriorityGet(nullptr) != placement.networkPriority)
+    {
+      vTaskPrioritySet(nullptr, placement.networkPriority);
+    }
+
+    pollControlUdp();
+    pollOscUdp();
+    pollHaloUdp();
+    pollDdpUdp();
+    vTaskDelay(1);
+  }
+}
+
+void queueTaskProfile(TaskProfile profile)
+{
+  pendingTaskProfile = profile;
+  taskProfilePending = true;
+}
+
+void applyPendingTaskProfile()
+{
+  if (!taskProfilePending)
+  {
+    return;
+  }
+  taskProfilePending = false;
+  taskProfile = pendingTaskProfile;
+
+  // The udp task picks up its core and priority on its next pass.
+  const TaskPlacement &placement = tasks::placement(taskProfile);
+  vTaskPrioritySet(renderTaskHandle, placement.renderPriority);
+  TaskHandle_t asyncTcp = xTaskGetHandle("async_tcp");
+  if (asyncTcp)
+  {
+    vTaskPrioritySet(asyncTcp, placement.asyncTcpPriority);
+  }
+
+  // Start a clean window so each profile's numbers are its own.
+  frameJitter.reset();
+  lastFrameUs = 0;
 }
 
 void initSPIFFS()
@@ -152,363 +718,2153 @@ void initNetworking()
   Serial.println(WiFi.softAPIP());
 }
 
+// Registered first so it sees every request before the real handlers.
+// Admitted requests pass through (canHandle() returns false); refused ones
+// are claimed and answered with a 503 that costs no file or state access.
+class AdmissionHandler : public AsyncWebHandler
+{
+public:
+  bool canHandle(AsyncWebServerRequest *request) override
+  {
+    uint32_t client = request->client()->getRemoteAddress();
+    if (admission.admit(client, classifyRequest(request->url()), millis()))
+    {
+      request->onDisconnect([request]()
+                            {
+                              admission.release();
+                              releaseBodySlot(request); });
+      return false;
+    }
+    return true;
+  }
+
+  void handleRequest(AsyncWebServerRequest *request) override
+  {
+    AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "Busy");
+    response->addHeader("Retry-After", "1");
+    request->send(response);
+  }
+};
+
+AdmissionHandler admissionHandler;
+
+RequestClass classifyRequest(const String &url)
+{
+  if (url.startsWith("/api/control") || url.startsWith("/api/overlay") || url.startsWith("/api/tempo") ||
+      url.startsWith("/api/tasks") || url.startsWith("/api/image") || url.startsWith("/api/gif"))
+  {
+    return RequestClass::Control;
+  }
+  if (url.startsWith("/api/"))
+  {
+    return RequestClass::State;
+  }
+  return RequestClass::Static;
+}
+
 void configureRoutes()
 {
+  server.addHandler(&admissionHandler);
+
   server.serveStatic("/", SPIFFS, "/").setDefaultFile("index.html");
 
   server.on("/api/state", HTTP_GET, [](AsyncWebServerRequest *request)
-            { request->send(200, "application/json", buildStateJson()); });
+            { sendBody(request, [](auto &writer)
+                       { writeState(writer); }); });
+
+  server.on("/api/effects", HTTP_GET, [](AsyncWebServerRequest *request)
+            { sendChunked(request, [](auto &writer, uint16_t step)
+                          { return writeCatalogStep(writer, step); }); });
 
   server.on("/api/control", HTTP_GET, [](AsyncWebServerRequest *request)
             { handleControlRequest(request); });
 
+  server.on("/api/control", HTTP_POST, handleControlBodyRequest, nullptr, handleControlBody);
+
+  server.on("/api/overlay", HTTP_GET, [](AsyncWebServerRequest *request)
+            { handleOverlayRequest(request); });
+
+  server.on("/api/tempo", HTTP_GET, [](AsyncWebServerRequest *request)
+            { handleTempoRequest(request); });
+
+  server.on("/api/tasks", HTTP_GET, [](AsyncWebServerRequest *request)
+            { handleTasksRequest(request); });
+
+  server.on("/api/image", HTTP_GET, handleImageRequest);
+  server.on("/api/image", HTTP_POST, handleImageUploadRequest, nullptr, handleImageUpload);
+
+  server.on("/api/gif", HTTP_GET, handleGifRequest);
+  server.on("/api/gif", HTTP_POST, handleGifUploadRequest, nullptr, handleGifUpload);
+
+  server.on("/api/stream", HTTP_GET, [](AsyncWebServerRequest *request)
+            { sendBody(request, [](auto &writer)
+                       { writeStream(writer); }); });
+
   server.onNotFound([](AsyncWebServerRequest *request)
                     { request->send(404, "text/plain", "Not found"); });
 }
 
 void handleControlRequest(AsyncWebServerRequest *request)
 {
-  bool changed = false;
-  bool colorChanged = false;
+  ControlUpdate update;
+  for (const char *name : ControlFieldNames)
+  {
+    if (request->hasParam(name))
+    {
+      setControlField(update, name, request->getParam(name)->value().c_str());
+    }
+  }
+  if (rejectInvalidControl(request, update))
+  {
+    return;
+  }
+  respondToControl(request, applyControlUpdate(update));
+}
 
-  if (request->hasParam("mode"))
+// Body chunks are parsed as they arrive and never buffered. A new body takes
+// over the parser; the request it displaced is answered with 409.
+void handleControlBody(AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t)
+{
+  if (index == 0)
+  {
+    controlBodyOwner = request;
+    controlBody.update = ControlUpdate();
+    controlParser.reset();
+  }
+  if (controlBodyOwner == request)
   {
-    changed |= applyModeFromString(request->getParam("mode")->value());
+    controlParser.feed(data, length);
   }
+}
 
-  if (request->hasParam("brightness"))
+void handleControlBodyRequest(AsyncWebServerRequest *request)
+{
+  if (controlBodyOwner != request)
   {
-    int value = request->getParam("brightness")->value().toInt();
-    changed |= setBrightness(static_cast<uint8_t>(constrain(value, 0, 255)));
+    if (request->contentLength() == 0)
+    {
+      request->send(400, "application/json", "{\"error\":\"expected a JSON body\"}");
+    }
+    else
+    {
+      request->send(409, "application/json", "{\"error\":\"superseded by another request\"}");
+    }
+    return;
   }
 
-  if (request->hasParam("count"))
+  controlBodyOwner = nullptr;
+  if (controlParser.finish() != JsonStreamParser::Status::Done)
+  {
+    char message[48];
+    snprintf(message, sizeof(message), "{\"error\":\"invalid JSON at byte %u\"}",
+             static_cast<unsigned>(controlParser.errorOffset()));
+    request->send(400, "application/json", message);
+    return;
+  }
+  if (rejectInvalidControl(request, controlBody.update))
   {
-    int value = request->getParam("count")->value().toInt();
-    changed |= setPixelCount(static_cast<uint16_t>(constrain(value, 1, MaxPixelCount)));
+    return;
   }
+  respondToControl(request, applyControlUpdate(controlBody.update));
+}
 
-  if (request->hasParam("r") && request->hasParam("g") && request->hasParam("b"))
+void ControlJsonHandler::onValue(const JsonStreamParser &parser, const JsonValue &value)
+{
+  bool topLevel = parser.depth() == 1;
+  bool inColor = parser.depth() == 2 && strcasecmp(parser.key(0), "color") == 0;
+  if ((!topLevel && !inColor) || value.type == JsonType::Null)
   {
-    int r = request->getParam("r")->value().toInt();
-    int g = request->getParam("g")->value().toInt();
-    int b = request->getParam("b")->value().toInt();
-    colorChanged |= setSolidColor(constrain(r, 0, 255), constrain(g, 0, 255), constrain(b, 0, 255));
-    changed |= colorChanged;
+    return;
   }
 
-  // Don't automatically switch to solid mode when color changes
+  const char *text = value.text;
+  if (value.type == JsonType::Bool)
+  {
+    text = value.boolean ? "1" : "0";
+  }
+  setControlField(update, parser.key(parser.depth() - 1), text, value.type == JsonType::Number);
+}
 
-  String payload = buildStateJson();
-  if (changed)
+// A 400 naming the first field with a bad value; true if one was sent.
+bool rejectInvalidControl(AsyncWebServerRequest *request, const ControlUpdate &update)
+{
+  for (size_t index = 0; index < static_cast<size_t>(ControlField::Count); ++index)
   {
-    Serial.println("State updated via web UI: " + payload);
+    if (update.invalid & (1u << index))
+    {
+      char message[48];
+      snprintf(message, sizeof(message), "{\"error\":\"invalid value for %s\"}", ControlFieldNames[index]);
+      request->send(400, "application/json", message);
+      return true;
+    }
   }
-  request->send(200, "application/json", payload);
+  return false;
 }
 
-String buildStateJson()
+// A whole number, or true/false for 1/0. A JSON number literal keeps only
+// its integer part; any other trailing text makes the value invalid.
+bool parseControlValue(ControlField field, const char *text, bool numberLiteral, int32_t &value)
 {
-  IPAddress currentIp = wifiConnected ? WiFi.localIP() : WiFi.softAPIP();
+  if (strcasecmp(text, "true") == 0 || strcasecmp(text, "false") == 0)
+  {
+    value = tolower(text[0]) == 't';
+    return true;
+  }
 
-  String json = "{";
-  json += "\"mode\":\"" + modeToString(stripState.effect) + "\",";
-  json += "\"brightness\":" + String(stripState.brightness) + ",";
-  json += "\"color\":{";
-  json += "\"r\":" + String(stripState.solidColor.R) + ",";
-  json += "\"g\":" + String(stripState.solidColor.G) + ",";
-  json += "\"b\":" + String(stripState.solidColor.B) + "},";
-  json += "\"count\":" + String(pixelCount) + ",";
-  json += "\"ip\":\"" + currentIp.toString() + "\"";
-  json += "}";
-  return json;
-}
-
-String modeToString(EffectMode mode)
-{
-  switch (mode)
-  {
-  case EffectMode::Solid:
-    return "solid";
-  case EffectMode::Snake:
-    return "snake";
-  case EffectMode::Off:
-    return "off";
-  default:
-    return "fade";
+  char *end = nullptr;
+  if (field == ControlField::Seed || field == ControlField::ShowTime)
+  {
+    value = static_cast<int32_t>(strtoul(text, &end, 10));
   }
+  else
+  {
+    value = static_cast<int32_t>(strtol(text, &end, 10));
+  }
+  return end != text && (*end == '\0' || numberLiteral);
 }
 
-bool applyModeFromString(const String &value)
+// Names match case-insensitively so /api/state keys like "beatSync" work.
+// A bad value marks the field invalid; the request is then refused whole.
+bool setControlField(ControlUpdate &update, const char *name, const char *text, bool numberLiteral)
 {
-  String lowered = value;
-  lowered.toLowerCase();
+  for (size_t index = 0; index < static_cast<size_t>(ControlField::Count); ++index)
+  {
+    if (strcasecmp(name, ControlFieldNames[index]) != 0)
+    {
+      continue;
+    }
+
+    ControlField field = static_cast<ControlField>(index);
+    char *target = field == ControlField::Mode     ? update.mode
+                   : field == ControlField::Easing ? update.easing
+                   : field == ControlField::Show   ? update.show
+                   : field == ControlField::Post   ? update.post
+                                                   : nullptr;
+    if (target)
+    {
+      strncpy(target, text, ControlUpdate::MaxNameLength - 1);
+      target[ControlUpdate::MaxNameLength - 1] = '\0';
+    }
+    else if (!parseControlValue(field, text, numberLiteral, update.values[index]))
+    {
+      update.invalid |= 1u << index;
+      return true;
+    }
+    update.present |= 1u << index;
+    return true;
+  }
+  return false;
+}
 
-  EffectMode next = stripState.effect;
-  if (lowered == "solid")
+bool applyControlUpdate(const ControlUpdate &update)
+{
+  bool changed = false;
+
+  if (update.has(ControlField::Mode))
   {
-    next = EffectMode::Solid;
+    changed |= applyModeFromString(update.mode);
   }
-  else if (lowered == "off")
+
+  if (update.has(ControlField::Brightness))
   {
-    next = EffectMode::Off;
+    changed |= setBrightness(static_cast<uint8_t>(constrain(update.value(ControlField::Brightness), 0, 255)));
   }
-  else if (lowered == "fade")
+
+  if (update.has(ControlField::PixelCount))
   {
-    next = EffectMode::Fade;
+    changed |= setPixelCount(static_cast<uint16_t>(constrain(update.value(ControlField::PixelCount), 1, MaxPixelCount)));
   }
-  else if (lowered == "snake")
+
+  if (update.has(ControlField::Easing))
   {
-    next = EffectMode::Snake;
+    changed |= setFadeEasing(update.easing);
   }
-  else
+
+  if (update.has(ControlField::Seed))
   {
-    return false;
+    changed |= setEffectSeed(static_cast<uint32_t>(update.value(ControlField::Seed)));
   }
 
-  if (stripState.effect == next)
+  if (update.has(ControlField::Kelvin))
   {
-    return false;
+    changed |= setKelvin(static_cast<uint16_t>(constrain(update.value(ControlField::Kelvin), kelvin::Min, kelvin::Max)));
   }
 
-  stripState.effect = next;
-  animations.StopAll();
-  fadeToColor = true;
-  solidDirty = true;
-  offDirty = true;
-  snakeDirty = true;
-  return true;
-}
+  if (update.has(ControlField::BeatSync))
+  {
+    bool beatSync = update.value(ControlField::BeatSync) != 0;
+    changed |= beatSync != stripState.beatSync;
+    stripState.beatSync = beatSync;
+  }
 
-bool setSolidColor(uint8_t r, uint8_t g, uint8_t b)
-{
-  if (stripState.solidColor.R == r && stripState.solidColor.G == g && stripState.solidColor.B == b)
+  if (update.has(ControlField::Show))
   {
-    return false;
+    changed |= selectShow(update.show);
   }
 
-  stripState.solidColor = RgbColor(r, g, b);
-  solidDirty = true;
-  snakeDirty = true;
-  return true;
-}
+  if (update.has(ControlField::ShowTime))
+  {
+    changed |= setShowPosition(static_cast<uint32_t>(update.value(ControlField::ShowTime)));
+  }
 
-bool setBrightness(uint8_t value)
-{
-  uint8_t constrained = constrain(value, 0, 255);
-  if (stripState.brightness == constrained)
+  StripLayout layout = stripState.layout;
+  if (update.has(ControlField::Offset))
   {
-    return false;
+    layout.offset = static_cast<uint16_t>(constrain(update.value(ControlField::Offset), 0, MaxPixelCount - 1));
+  }
+  if (update.has(ControlField::Reverse))
+  {
+    layout.reverse = update.value(ControlField::Reverse) != 0;
+  }
+  if (update.has(ControlField::Mirror))
+  {
+    layout.mirror = update.value(ControlField::Mirror) != 0;
+  }
+  if (update.has(ControlField::Group))
+  {
+    layout.group = static_cast<uint8_t>(constrain(update.value(ControlField::Group), 1, 16));
+  }
+  if (update.has(ControlField::Length))
+  {
+    layout.renderLength = static_cast<uint16_t>(constrain(update.value(ControlField::Length), 0, MaxPixelCount));
   }
+  if (update.has(ControlField::Smooth))
+  {
+    layout.interpolate = update.value(ControlField::Smooth) != 0;
+  }
+  changed |= setLayout(layout);
 
-  stripState.brightness = constrained;
-  solidDirty = true;
-  offDirty = true;
-  snakeDirty = true;
-  animations.StopAll();
-  return true;
-}
+  if (update.has(ControlField::Trails))
+  {
+    changed |= setTrails(static_cast<uint8_t>(constrain(update.value(ControlField::Trails), 0, 255)));
+  }
 
-bool setPixelCount(uint16_t count)
-{
-  uint16_t newCount = constrain(count, 1, MaxPixelCount);
-  if (pixelCount == newCount)
+  if (update.has(ControlField::Post) || update.has(ControlField::PostStrength))
   {
-    return false;
+    changed |= setPostChain(update.has(ControlField::Post) ? update.post : stripState.post,
+                            update.has(ControlField::PostStrength)
+                                ? static_cast<uint8_t>(constrain(update.value(ControlField::PostStrength), 0, 255))
+                                : stripState.postStrength);
   }
 
-  pixelCount = newCount;
-  solidDirty = true;
-  offDirty = true;
-  snakeDirty = true;
-  animations.StopAll();
-  return true;
-}
+  if (update.has(ControlField::Node) || update.has(ControlField::Nodes))
+  {
+    uint8_t nodes = update.has(ControlField::Nodes)
+                        ? static_cast<uint8_t>(constrain(update.value(ControlField::Nodes), 1, HaloExchange::MaxNodes))
+                        : stripState.nodes;
+    uint8_t node = update.has(ControlField::Node)
+                       ? static_cast<uint8_t>(constrain(update.value(ControlField::Node), 0, nodes - 1))
+                       : min<uint8_t>(stripState.node, nodes - 1);
+    changed |= setCanvasSlice(node, nodes);
+  }
 
-float brightnessScale()
-{
-  float percent = static_cast<float>(stripState.brightness) / 255.0f;
-  return percent * percent; // Gamma correction to make low values dimmer
+  if (update.has(ControlField::Red) && update.has(ControlField::Green) && update.has(ControlField::Blue))
+  {
+    changed |= setSolidColor(constrain(update.value(ControlField::Red), 0, 255),
+                             constrain(update.value(ControlField::Green), 0, 255),
+                             constrain(update.value(ControlField::Blue), 0, 255));
+  }
+
+  // Don't automatically switch to solid mode when color changes
+
+  return changed;
 }
 
-float brightnessToLuminance()
+void respondToControl(AsyncWebServerRequest *request, bool changed)
 {
-  float luminance = brightnessScale() * 0.5f;
-  if (stripState.brightness == 0)
+  if (changed)
   {
-    return 0.0f;
+    logState();
   }
-  return max(0.002f, luminance);
+  sendBody(request, [](auto &writer)
+           { writeState(writer); });
 }
 
-RgbColor applyBrightness(const RgbColor &color)
+void handleOverlayRequest(AsyncWebServerRequest *request)
 {
-  return scaleColor(color, brightnessScale());
+  OverlayRequest overlayRequest;
+  String type = request->hasParam("type") ? request->getParam("type")->value() : String("flash");
+  type.toLowerCase();
+  if (!overlayKindFromName(type.c_str(), overlayRequest.kind))
+  {
+    request->send(400, "application/json", "{\"error\":\"unknown overlay type\"}");
+    return;
+  }
+
+  if (request->hasParam("r") && request->hasParam("g") && request->hasParam("b"))
+  {
+    overlayRequest.r = constrain(request->getParam("r")->value().toInt(), 0, 255);
+    overlayRequest.g = constrain(request->getParam("g")->value().toInt(), 0, 255);
+    overlayRequest.b = constrain(request->getParam("b")->value().toInt(), 0, 255);
+  }
+  if (request->hasParam("ttl"))
+  {
+    overlayRequest.ttlMs = constrain(request->getParam("ttl")->value().toInt(), 1, Overlay::MaxTtlMs);
+  }
+
+  queueOverlay(overlayRequest);
+  request->send(200, "application/json", "{\"ok\":true}");
 }
 
-RgbColor scaleColor(const RgbColor &color, float scale)
+void handleTasksRequest(AsyncWebServerRequest *request)
 {
-  float clamped = constrain(scale, 0.0f, 1.0f);
-  uint8_t r = static_cast<uint8_t>(color.R * clamped);
-  uint8_t g = static_cast<uint8_t>(color.G * clamped);
-  uint8_t b = static_cast<uint8_t>(color.B * clamped);
-  return RgbColor(r, g, b);
+  if (request->hasParam("profile"))
+  {
+    TaskProfile profile;
+    if (!tasks::fromName(request->getParam("profile")->value().c_str(), profile))
+    {
+      request->send(400, "application/json", "{\"error\":\"unknown task profile\"}");
+      return;
+    }
+    queueTaskProfile(profile);
+  }
+
+  sendBody(request, [](auto &writer)
+           { writeTasks(writer); });
 }
 
-void writeColorToActivePixels(const RgbColor &color)
+// Stages ?scroll= and ?spin=; true if either was given.
+bool stageImageMotion(AsyncWebServerRequest *request)
 {
-  for (uint16_t pixel = 0; pixel < pixelCount; ++pixel)
+  bool staged = false;
+  if (request->hasParam("scroll"))
   {
-    strip.SetPixelColor(pixel, color);
+    pendingImageScroll = static_cast<int16_t>(constrain(request->getParam("scroll")->value().toInt(), -255, 255));
+    staged = true;
   }
-  // Clear any pixels beyond pixelCount
-  for (uint16_t pixel = pixelCount; pixel < MaxPixelCount; ++pixel)
+  if (request->hasParam("spin"))
   {
-    strip.SetPixelColor(pixel, RgbColor(0));
+    pendingImageSpinMs = static_cast<uint16_t>(constrain(request->getParam("spin")->value().toInt(), 0, 60000));
+    staged = true;
   }
+  return staged;
 }
 
-void applySolidColor()
+void handleImageRequest(AsyncWebServerRequest *request)
 {
-  writeColorToActivePixels(applyBrightness(stripState.solidColor));
-  strip.Show();
-  solidDirty = false;
-  offDirty = true;
-}
+  if (stageImageMotion(request))
+  {
+    imageMotionPending = true;
+  }
 
-void turnStripOff()
-{
-  writeColorToActivePixels(RgbColor(0));
-  strip.Show();
-  offDirty = false;
-  solidDirty = true;
+  sendBody(request, [](auto &writer)
+           { writeImage(writer); });
 }
 
-void resetSnakeEffect()
+// Raw RGB rows, size given as ?w=&h=; streamed into the image's upload
+// buffer while the current image keeps playing. The render task swaps it in.
+void handleImageUpload(AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total)
 {
-  snakeHead = 0;
-  lastSnakeStepMs = 0;
-  snakeDirty = false;
-  writeColorToActivePixels(RgbColor(0));
-  strip.Show();
+  if (index == 0)
+  {
+    imageUploadOwner = request;
+    int width = request->hasParam("w") ? request->getParam("w")->value().toInt() : 0;
+    int height = request->hasParam("h") ? request->getParam("h")->value().toInt() : 0;
+    imageUploadFailed = imageFinishPending || imageSavePending || // Previous upload not swapped in or saved yet
+                        width <= 0 || height <= 0 ||
+                        !image.begin(static_cast<uint8_t>(constrain(width, 0, 255)), static_cast<uint8_t>(constrain(height, 0, 255))) ||
+                        total != image.uploadByteCount();
+  }
+  if (imageUploadOwner == request && !imageUploadFailed)
+  {
+    imageUploadFailed = !image.write(index, data, length);
+  }
 }
 
-void runSnakeEffect()
+void handleImageUploadRequest(AsyncWebServerRequest *request)
 {
-  if (snakeDirty)
+  if (imageUploadOwner != request)
   {
-    resetSnakeEffect();
+    request->send(request->contentLength() ? 409 : 400, "application/json",
+                  "{\"error\":\"expected one RGB image body\"}");
+    return;
   }
 
-  unsigned long now = millis();
-  if (lastSnakeStepMs && now - lastSnakeStepMs < SnakeStepDelayMs)
+  imageUploadOwner = nullptr;
+  if (imageUploadFailed && (imageFinishPending || imageSavePending))
   {
+    request->send(409, "application/json", "{\"error\":\"previous image still being applied\"}");
+    return;
+  }
+  if (imageUploadFailed)
+  {
+    request->send(400, "application/json", "{\"error\":\"expected w*h*3 bytes of RGB, at most 64x64\"}");
     return;
   }
 
-  lastSnakeStepMs = now;
-  RgbColor baseColor = applyBrightness(stripState.solidColor);
+  stageImageMotion(request); // Taken over with the image
+  imageFinishPending = true;
+  sendBody(request, [](auto &writer)
+           { writeImage(writer); });
+}
+
+void handleGifRequest(AsyncWebServerRequest *request)
+{
+  sendBody(request, [](auto &writer)
+           { writeGif(writer); });
+}
+
+// The GIF file as the raw body; written to SPIFFS as it arrives.
+void handleGifUpload(AsyncWebServerRequest *request, uint8_t *data, size_t length, size_t index, size_t total)
+{
+  if (index == 0)
+  {
+    gifUploadOwner = request;
+    // Previous upload not swapped in, or its old slot not removed yet.
+    gifUploadFailed = total > MaxGifBytes || gifReplacePending || gifRemovePending;
+    if (!gifUploadFailed)
+    {
+      gifUpload = SPIFFS.open(GifPaths[gifSlot ^ 1], "w");
+      gifUploadFailed = !gifUpload;
+    }
+  }
+  if (gifUploadOwner != request || gifUploadFailed)
+  {
+    return;
+  }
+
+  gifUploadFailed = gifUpload.write(data, length) != length;
+  if (index + length == total || gifUploadFailed)
+  {
+    gifUpload.close();
+  }
+}
+
+void handleGifUploadRequest(AsyncWebServerRequest *request)
+{
+  if (gifUploadOwner != request)
+  {
+    request->send(request->contentLength() ? 409 : 400, "application/json",
+                  "{\"error\":\"expected one GIF body\"}");
+    return;
+  }
+
+  gifUploadOwner = nullptr;
+  if (gifUploadFailed && (gifReplacePending || gifRemovePending))
+  {
+    request->send(409, "application/json", "{\"error\":\"previous GIF still being applied\"}");
+    return;
+  }
+  if (gifUploadFailed)
+  {
+    SPIFFS.remove(GifPaths[gifSlot ^ 1]);
+    request->send(400, "application/json", "{\"error\":\"GIF missing or larger than 512 KB\"}");
+    return;
+  }
+
+  gifReplacePending = true;
+  sendBody(request, [](auto &writer)
+           { writeGif(writer); });
+}
+
+void queueOverlay(const OverlayRequest &request)
+{
+  pendingOverlay = request;
+  overlayTriggerUs = micros();
+  overlayPending = true;
+}
+
+// Non-blocking; polled once per frame so a trigger is shown on the next frame.
+void pollControlUdp()
+{
+  while (controlUdp.parsePacket() > 0)
+  {
+    uint8_t packet[OverlayPacketSize];
+    int length = controlUdp.read(packet, sizeof(packet));
+    if (length == 1 && packet[0] == 'T')
+    {
+      queueTap();
+      continue;
+    }
+    if (length == TempoPacketSize && packet[0] == 'B')
+    {
+      queueBpm(packet[1] | (packet[2] << 8));
+      continue;
+    }
+    if (length != OverlayPacketSize || packet[0] != 'O' || packet[1] == 0 ||
+        packet[1] > static_cast<uint8_t>(OverlayKind::Pulse))
+    {
+      continue;
+    }
+
+    OverlayRequest request;
+    request.kind = static_cast<OverlayKind>(packet[1]);
+    request.r = packet[2];
+    request.g = packet[3];
+    request.b = packet[4];
+    request.ttlMs = packet[5] | (packet[6] << 8);
+    queueOverlay(request);
+  }
+}
+
+// Halo packets from the neighbouring nodes. A packet that arrives while the
+// last one from the same side is still queued is dropped; a newer one
+// follows within a frame or two.
+void pollHaloUdp()
+{
+  while (haloUdp.parsePacket() > 0)
+  {
+    uint8_t packet[HaloExchange::PacketSize];
+    int length = haloUdp.read(packet, sizeof(packet));
+    int8_t side = length > 0 ? HaloExchange::side(canvasSlice(), packet, length) : 0;
+    uint8_t index = side > 0;
+    if (!side || haloPending[index])
+    {
+      continue;
+    }
+    memcpy(pendingHalo[index], packet, sizeof(packet));
+    haloPending[index] = true;
+  }
+}
+
+// DDP from a host renderer. A frame that completes while the last one is
+// still waiting for the render task is dropped; the sender is ahead of the
+// strip's frame rate.
+void pollDdpUdp()
+{
+  while (ddpUdp.parsePacket() > 0)
+  {
+    int length = ddpUdp.read(ddpPacket, sizeof(ddpPacket));
+    if (length <= 0 || !streamReceiver.receive(ddpPacket, length))
+    {
+      continue;
+    }
+    if (streamPending)
+    {
+      ++streamLate;
+      continue;
+    }
+    memcpy(pendingStream, streamReceiver.data(), streamReceiver.length());
+    pendingStreamLength = streamReceiver.length();
+    streamPending = true;
+  }
+}
+
+// OSC from control surfaces: /tempo/tap, /tempo/bpm <bpm>.
+void pollOscUdp()
+{
+  while (oscUdp.parsePacket() > 0)
+  {
+    uint8_t packet[64];
+    int length = oscUdp.read(packet, sizeof(packet));
+    OscMessage message;
+    if (length <= 0 || !parseOscMessage(packet, length, message))
+    {
+      continue;
+    }
+
+    if (strcmp(message.address, "/tempo/tap") == 0)
+    {
+      queueTap();
+    }
+    else if (strcmp(message.address, "/tempo/bpm") == 0 && message.hasArgument)
+    {
+      queueBpm(static_cast<uint16_t>(constrain(message.argument, 0.0f, 300.0f) * 100.0f + 0.5f));
+    }
+  }
+}
+
+void handleTempoRequest(AsyncWebServerRequest *request)
+{
+  if (request->hasParam("tap"))
+  {
+    queueTap();
+  }
+  if (request->hasParam("bpm"))
+  {
+    float bpm = request->getParam("bpm")->value().toFloat();
+    queueBpm(static_cast<uint16_t>(constrain(bpm, 0.0f, 300.0f) * 100.0f + 0.5f));
+  }
+  sendBody(request, [](auto &writer)
+           { writeTempo(writer); });
+}
+
+void queueTap()
+{
+  pendingTapMs = millis();
+  tapPending = true;
+}
+
+// 0 stops the clock.
+void queueBpm(uint16_t centiBpm)
+{
+  pendingCentiBpm = centiBpm;
+  bpmPending = true;
+}
+
+void applyPendingTempo()
+{
+  if (bpmPending)
+  {
+    bpmPending = false;
+    if (pendingCentiBpm == 0)
+    {
+      beatClock.stop();
+    }
+    else
+    {
+      beatClock.setBpm(pendingCentiBpm, millis());
+    }
+  }
+  if (tapPending)
+  {
+    tapPending = false;
+    beatClock.tap(pendingTapMs);
+  }
+}
+
+// Honors Accept: application/cbor and application/msgpack (or x-msgpack);
+// anything else gets JSON.
+WireFormat negotiateFormat(AsyncWebServerRequest *request)
+{
+  if (!request->hasHeader("Accept"))
+  {
+    return WireFormat::Json;
+  }
+
+  const String &accept = request->getHeader("Accept")->value();
+  if (accept.indexOf("application/cbor") >= 0)
+  {
+    return WireFormat::Cbor;
+  }
+  if (accept.indexOf("msgpack") >= 0)
+  {
+    return WireFormat::MsgPack;
+  }
+  return WireFormat::Json;
+}
+
+uint8_t *claimBodySlot(AsyncWebServerRequest *request)
+{
+  for (BodySlot &slot : bodySlots)
+  {
+    if (!slot.owner)
+    {
+      slot.owner = request;
+      return slot.bytes;
+    }
+  }
+  return nullptr;
+}
+
+void releaseBodySlot(AsyncWebServerRequest *request)
+{
+  for (BodySlot &slot : bodySlots)
+  {
+    if (slot.owner == request)
+    {
+      slot.owner = nullptr;
+    }
+  }
+}
+
+// Serves the body from its slot as the TCP send path asks for it, with no
+// copy on the heap.
+template <typename Writer>
+void sendEncoded(AsyncWebServerRequest *request, const Writer &writer, const char *contentType)
+{
+  if (writer.overflowed())
+  {
+    releaseBodySlot(request);
+    request->send(500, "text/plain", "Response too large");
+    return;
+  }
+
+  const uint8_t *bytes = writer.bytes();
+  size_t length = writer.length();
+  AsyncWebServerResponse *response = request->beginResponse(
+      contentType, length, [bytes, length](uint8_t *buffer, size_t maxLength, size_t index)
+      {
+        size_t count = min(maxLength, length - index);
+        memcpy(buffer, bytes + index, count);
+        return count; });
+  response->addHeader("Vary", "Accept");
+  request->send(response);
+}
+
+// Encodes `body` (a callable taking any writer) in the negotiated format.
+template <typename Body>
+void sendBody(AsyncWebServerRequest *request, Body body)
+{
+  uint8_t *bytes = claimBodySlot(request);
+  if (!bytes)
+  {
+    request->send(503, "text/plain", "Busy");
+    return;
+  }
+
+  switch (negotiateFormat(request))
+  {
+  case WireFormat::Cbor:
+  {
+    CborWriter writer(bytes, EncodeBufferSize);
+    body(writer);
+    sendEncoded(request, writer, "application/cbor");
+    break;
+  }
+  case WireFormat::MsgPack:
+  {
+    MsgPackWriter writer(bytes, EncodeBufferSize);
+    body(writer);
+    sendEncoded(request, writer, "application/msgpack");
+    break;
+  }
+  default:
+  {
+    JsonWriter writer(bytes, EncodeBufferSize);
+    body(writer);
+    sendEncoded(request, writer, "application/json");
+    break;
+  }
+  }
+}
+
+template <typename Writer, typename Source>
+void beginChunked(AsyncWebServerRequest *request, Source source, const char *contentType)
+{
+  // Shared so the filler stays copyable; the encoder lives until the
+  // response (and with it the filler) is destroyed.
+  auto encoder = std::make_shared<ChunkedEncoder<Writer, Source>>(source);
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      contentType, [encoder](uint8_t *buffer, size_t maxLength, size_t)
+      { return encoder->fill(buffer, maxLength); });
+  response->addHeader("Vary", "Accept");
+  request->send(response);
+}
+
+// For payloads that grow with content (lists, histories): generated step by
+// step straight into the TCP send buffer, see chunked_encoder.h.
+template <typename Source>
+void sendChunked(AsyncWebServerRequest *request, Source source)
+{
+  switch (negotiateFormat(request))
+  {
+  case WireFormat::Cbor:
+    beginChunked<CborWriter>(request, source, "application/cbor");
+    break;
+  case WireFormat::MsgPack:
+    beginChunked<MsgPackWriter>(request, source, "application/msgpack");
+    break;
+  default:
+    beginChunked<JsonWriter>(request, source, "application/json");
+    break;
+  }
+}
+
+template <typename Writer>
+void writeTempo(Writer &writer)
+{
+  writer.beginMap(3);
+  writer.key("bpm");
+  writer.decimal(beatClock.bpm100() / 100.0f);
+  writer.key("beat");
+  writer.unsignedInt(beatClock.beat());
+  writer.key("phase");
+  writer.unsignedInt(beatClock.phase8());
+  writer.endMap();
+}
+
+template <typename Writer>
+void writeState(Writer &writer)
+{
+  IPAddress currentIp = wifiConnected ? WiFi.localIP() : WiFi.softAPIP();
+
+  writer.beginMap(26);
+  writer.key("mode");
+  writer.text(effectFor(stripState.effect).name);
+  writer.key("brightness");
+  writer.unsignedInt(stripState.brightness);
+  writer.key("easing");
+  writer.text(easing::name(stripState.fadeEasing));
+  writer.key("color");
+  writer.beginMap(3);
+  writer.key("r");
+  writer.unsignedInt(stripState.solidColor.R);
+  writer.key("g");
+  writer.unsignedInt(stripState.solidColor.G);
+  writer.key("b");
+  writer.unsignedInt(stripState.solidColor.B);
+  writer.endMap();
+  writer.key("count");
+  writer.unsignedInt(pixelCount);
+  writer.key("kelvin");
+  writer.unsignedInt(stripState.kelvin);
+  writer.key("bpm");
+  writer.decimal(beatClock.bpm100() / 100.0f);
+  writer.key("beatSync");
+  writer.boolean(stripState.beatSync);
+  writer.key("seed");
+  writer.unsignedInt(effectSeed());
+  writer.key("show");
+  writer.text(BuiltInShows[stripState.showIndex]->name);
+  writer.key("showTime");
+  writer.unsignedInt(showPosition(millis()));
+  writer.key("overlayLatencyUs");
+  writer.unsignedInt(overlayLatencyUs);
+  writer.key("offset");
+  writer.unsignedInt(stripState.layout.offset);
+  writer.key("reverse");
+  writer.boolean(stripState.layout.reverse);
+  writer.key("mirror");
+  writer.boolean(stripState.layout.mirror);
+  writer.key("group");
+  writer.unsignedInt(stripState.layout.group);
+  writer.key("length");
+  writer.unsignedInt(stripState.layout.renderLength);
+  writer.key("smooth");
+  writer.boolean(stripState.layout.interpolate);
+  writer.key("trails");
+  writer.unsignedInt(stripState.trails);
+  writer.key("post");
+  writer.text(stripState.post);
+  writer.key("postStrength");
+  writer.unsignedInt(stripState.postStrength);
+  writer.key("node");
+  writer.unsignedInt(stripState.node);
+  writer.key("nodes");
+  writer.unsignedInt(stripState.nodes);
+  writer.key("slack");
+  writer.unsignedInt(admission.slackPercent());
+  writer.key("rejected");
+  writer.unsignedInt(admission.rejected());
+  writer.key("ip");
+  writer.text(currentIp.toString().c_str());
+  writer.endMap();
+}
+
+// Everything the UI can pick from: effects, fade easings and built-in shows.
+// One step per list entry, plus one to open each list and one to finish.
+template <typename Writer>
+bool writeCatalogStep(Writer &writer, uint16_t step)
+{
+  constexpr uint16_t EffectCount = sizeof(Effects) / sizeof(Effects[0]);
+  constexpr uint16_t EasingCount = static_cast<uint16_t>(Easing::Count);
+
+  if (step == 0)
+  {
+    writer.beginMap(3);
+    writer.key("effects");
+    writer.beginArray(EffectCount);
+    return true;
+  }
+  step -= 1;
+  if (step < EffectCount)
+  {
+    writer.beginMap(2);
+    writer.key("name");
+    writer.text(Effects[step].name);
+    writer.key("animated");
+    writer.boolean(Effects[step].animated);
+    writer.endMap();
+    return true;
+  }
+  step -= EffectCount;
+
+  if (step == 0)
+  {
+    writer.endArray();
+    writer.key("easings");
+    writer.beginArray(EasingCount);
+    return true;
+  }
+  step -= 1;
+  if (step < EasingCount)
+  {
+    writer.text(easing::name(static_cast<Easing>(step)));
+    return true;
+  }
+  step -= EasingCount;
+
+  if (step == 0)
+  {
+    writer.endArray();
+    writer.key("shows");
+    writer.beginArray(BuiltInShowCount);
+    return true;
+  }
+  step -= 1;
+  if (step < BuiltInShowCount)
+  {
+    writer.beginMap(3);
+    writer.key("name");
+    writer.text(BuiltInShows[step]->name);
+    writer.key("durationMs");
+    writer.unsignedInt(BuiltInShows[step]->durationMs);
+    writer.key("loop");
+    writer.boolean(BuiltInShows[step]->loop);
+    writer.endMap();
+    return true;
+  }
+
+  writer.endArray();
+  writer.endMap();
+  return false;
+}
+
+template <typename Writer>
+void writeTasks(Writer &writer)
+{
+  const TaskPlacement &placement = tasks::placement(taskProfile);
+
+  writer.beginMap(7);
+  writer.key("profile");
+  writer.text(tasks::name(taskProfile));
+  writer.key("periodUs");
+  writer.unsignedInt(FrameBudgetUs);
+  writer.key("cores");
+  writer.beginMap(3);
+  writer.key("render");
+  writer.unsignedInt(tasks::RenderCore);
+  writer.key("network");
+  writer.unsignedInt(placement.networkCore);
+  writer.key("asyncTcp");
+  writer.unsignedInt(tasks::AsyncTcpCore);
+  writer.endMap();
+  writer.key("priorities");
+  writer.beginMap(3);
+  writer.key("render");
+  writer.unsignedInt(placement.renderPriority);
+  writer.key("network");
+  writer.unsignedInt(placement.networkPriority);
+  writer.key("asyncTcp");
+  writer.unsignedInt(placement.asyncTcpPriority);
+  writer.endMap();
+  writer.key("jitter");
+  writer.beginMap(static_cast<uint8_t>(TaskProfile::Count));
+  for (uint8_t index = 0; index < static_cast<uint8_t>(TaskProfile::Count); ++index)
+  {
+    const JitterResult &result = profileJitter[index];
+    writer.key(tasks::name(static_cast<TaskProfile>(index)));
+    writer.beginMap(4);
+    writer.key("p99Us");
+    writer.unsignedInt(result.p99Us);
+    writer.key("maxUs");
+    writer.unsignedInt(result.maxUs);
+    writer.key("meanUs");
+    writer.unsignedInt(result.meanUs);
+    writer.key("frames");
+    writer.unsignedInt(result.frames);
+    writer.endMap();
+  }
+  writer.endMap();
+  writer.key("post");
+  writer.beginMap(2);
+  writer.key("us");
+  writer.unsignedInt(postUs);
+  writer.key("nsPerTap"); // Per pixel, all three channels
+  uint32_t taps = static_cast<uint32_t>(postChain.tapCount()) * pixelMap.logicalCount();
+  writer.unsignedInt(taps ? postUs * 1000 / taps : 0);
+  writer.endMap();
+  writer.key("slack");
+  writer.unsignedInt(admission.slackPercent());
+  writer.endMap();
+}
+
+template <typename Writer>
+void writeImage(Writer &writer)
+{
+  writer.beginMap(5);
+  writer.key("loaded");
+  writer.boolean(image.loaded() || imageFinishPending);
+  writer.key("width");
+  writer.unsignedInt(imageFinishPending ? image.uploadWidth() : image.width());
+  writer.key("height");
+  writer.unsignedInt(imageFinishPending ? image.uploadHeight() : image.height());
+  writer.key("scroll");
+  writer.integer(pendingImageScroll);
+  writer.key("spin");
+  writer.unsignedInt(pendingImageSpinMs);
+  writer.endMap();
+}
+
+template <typename Writer>
+void writeStream(Writer &writer)
+{
+  writer.beginMap(6);
+  writer.key("active");
+  writer.boolean(streaming);
+  writer.key("frames");
+  writer.unsignedInt(streamFrames);
+  writer.key("late");
+  writer.unsignedInt(streamLate);
+  writer.key("lost");
+  writer.unsignedInt(streamReceiver.lost());
+  writer.key("fallbacks");
+  writer.unsignedInt(streamFallbacks);
+  writer.key("ageMs");
+  writer.unsignedInt(lastStreamMs ? millis() - lastStreamMs : 0);
+  writer.endMap();
+}
+
+// Decode cost against the frame budget; decoding runs inside the frame.
+template <typename Writer>
+void writeGif(Writer &writer)
+{
+  writer.beginMap(7);
+  writer.key("loaded");
+  writer.boolean(gif.isOpen() || gifReplacePending);
+  writer.key("width");
+  writer.unsignedInt(gif.width());
+  writer.key("height");
+  writer.unsignedInt(gif.height());
+  writer.key("delayMs");
+  writer.unsignedInt(gif.frameDelayMs());
+  writer.key("decodeUs");
+  writer.unsignedInt(gifDecodeUs);
+  writer.key("maxDecodeUs");
+  writer.unsignedInt(gifMaxDecodeUs);
+  writer.key("budget");
+  writer.unsignedInt(gifMaxDecodeUs * 100 / FrameBudgetUs);
+  writer.endMap();
+}
+
+void logState()
+{
+  stateLogPending = true;
+}
+
+void flushLog()
+{
+  if (!stateLogPending)
+  {
+    return;
+  }
+  stateLogPending = false;
+
+  JsonWriter writer(logBuffer, sizeof(logBuffer));
+  writeState(writer);
+  Serial.print("State updated via web UI: ");
+  Serial.write(writer.bytes(), writer.length());
+  Serial.println();
+}
+
+bool applyModeFromString(const String &value)
+{
+  String lowered = value;
+  lowered.toLowerCase();
+
+  for (size_t index = 0; index < sizeof(Effects) / sizeof(Effects[0]); ++index)
+  {
+    if (lowered != Effects[index].name)
+    {
+      continue;
+    }
+
+    EffectMode next = static_cast<EffectMode>(index);
+    if (stripState.effect == next)
+    {
+      return false;
+    }
+
+    stripState.effect = next;
+    restartEffect();
+    return true;
+  }
+  return false;
+}
+
+bool setSolidColor(uint8_t r, uint8_t g, uint8_t b)
+{
+  if (stripState.solidColor.R == r && stripState.solidColor.G == g && stripState.solidColor.B == b)
+  {
+    return false;
+  }
+
+  stripState.solidColor = RgbColor(r, g, b);
+  invalidateFrame();
+  return true;
+}
+
+bool setBrightness(uint8_t value)
+{
+  uint8_t constrained = constrain(value, 0, 255);
+  if (stripState.brightness == constrained)
+  {
+    return false;
+  }
+
+  stripState.brightness = constrained;
+  restartEffect();
+  return true;
+}
+
+bool setPixelCount(uint16_t count)
+{
+  uint16_t newCount = constrain(count, 1, MaxPixelCount);
+  if (pixelCount == newCount)
+  {
+    return false;
+  }
+
+  pixelCount = newCount;
+  pixelCountPending = true;
+  return true;
+}
+
+// Live resize: the running effect keeps going over the new range. Only the
+// newly uncovered logical tail is cleared; LEDs beyond the count are dark via
+// the pixel map. Static effects re-render once to cover the new range.
+void applyPixelCount()
+{
+  pixelCountPending = false;
+  uint16_t oldCount = pixelMap.logicalCount();
+  rebuildPixelMap();
+  uint16_t newCount = pixelMap.logicalCount();
+
+  for (uint16_t pixel = oldCount; pixel < newCount; ++pixel)
+  {
+    frame[pixel] = RgbColor(0);
+  }
+
+  const EffectDefinition &effect = effectFor(runningEffect);
+  if (effect.resize)
+  {
+    effect.resize(oldCount, newCount);
+  }
+  invalidateFrame();
+}
+
+bool setFadeEasing(const String &name)
+{
+  String lowered = name;
+  lowered.toLowerCase();
+
+  Easing next = stripState.fadeEasing;
+  if (!easing::fromName(lowered.c_str(), next) || next == stripState.fadeEasing)
+  {
+    return false;
+  }
+
+  // Takes effect from the next frame; the running fade keeps its endpoints.
+  stripState.fadeEasing = next;
+  return true;
+}
+
+// Restarts effect randomness from a known seed so several logos can play
+// the same sequence. The render task reseeds ahead of the restart.
+bool setEffectSeed(uint32_t seed)
+{
+  if (seed == effectSeed())
+  {
+    return false;
+  }
+
+  pendingSeed = seed;
+  seedPending = true;
+  if (stripState.effect == EffectMode::Fade)
+  {
+    restartEffect();
+  }
+  return true;
+}
+
+// The seed in use, or the one queued for the next frame.
+uint32_t effectSeed()
+{
+  return seedPending ? pendingSeed : fadeRandom.seed();
+}
+
+void applyPendingSeed()
+{
+  seedPending = false;
+  fadeRandom.reseed(pendingSeed);
+}
+
+bool setKelvin(uint16_t value)
+{
+  if (stripState.kelvin == value)
+  {
+    return false;
+  }
+
+  stripState.kelvin = value;
+  pendingKelvin = value;
+  kelvinPending = true;
+  invalidateFrame();
+  return true;
+}
+
+void applyPendingKelvin()
+{
+  kelvinPending = false;
+  unsigned long now = millis();
+  kelvinFrom = displayedKelvin(now);
+  kelvinChangedMs = now;
+  kelvinTo = pendingKelvin;
+}
+
+bool setTrails(uint8_t decay)
+{
+  if (stripState.trails == decay)
+  {
+    return false;
+  }
+  stripState.trails = decay;
+  invalidateFrame();
+  return true;
+}
+
+bool setPostChain(const char *spec, uint8_t strength)
+{
+  if (!PostChain::valid(spec) || (strcmp(spec, stripState.post) == 0 && strength == stripState.postStrength))
+  {
+    return false;
+  }
+  if (spec != stripState.post)
+  {
+    strcpy(stripState.post, *spec ? spec : "off");
+  }
+  stripState.postStrength = strength;
+  strcpy(pendingPost, stripState.post);
+  pendingPostStrength = strength;
+  postPending = true;
+  return true;
+}
+
+// Canvas-wide effects restart so every node picks up the new geometry.
+bool setCanvasSlice(uint8_t node, uint8_t nodes)
+{
+  if (stripState.node == node && stripState.nodes == nodes)
+  {
+    return false;
+  }
+  stripState.node = node;
+  stripState.nodes = nodes;
+  restartEffect();
+  return true;
+}
+
+CanvasSlice canvasSlice()
+{
+  CanvasSlice slice;
+  slice.node = stripState.node;
+  slice.nodes = stripState.nodes;
+  slice.count = pixelMap.logicalCount();
+  return slice;
+}
+
+uint16_t displayedKelvin(unsigned long now)
+{
+  unsigned long elapsed = now - kelvinChangedMs;
+  if (elapsed >= KelvinTransitionMs)
+  {
+    return kelvinTo;
+  }
+
+  uint8_t weight = easing::ease(Easing::InOutSine, static_cast<uint8_t>(elapsed * 255 / KelvinTransitionMs));
+  int32_t delta = static_cast<int32_t>(kelvinTo) - kelvinFrom;
+  return static_cast<uint16_t>(kelvinFrom + (delta * weight) / 255);
+}
+
+bool selectShow(const String &name)
+{
+  String lowered = name;
+  lowered.toLowerCase();
+
+  for (uint8_t index = 0; index < BuiltInShowCount; ++index)
+  {
+    if (lowered != BuiltInShows[index]->name)
+    {
+      continue;
+    }
+    if (stripState.showIndex == index)
+    {
+      return false;
+    }
+
+    stripState.showIndex = index;
+    queueShowOrigin(millis());
+    if (stripState.effect == EffectMode::Show)
+    {
+      restartEffect();
+    }
+    return true;
+  }
+  return false;
+}
+
+// Jumps the show clock; send the same position to every logo to sync them.
+// A position within a frame of where the clock already is, as a periodic
+// sync sends, is not a jump.
+bool setShowPosition(uint32_t positionMs)
+{
+  unsigned long now = millis();
+  int32_t offset = static_cast<int32_t>(showPosition(now) - positionMs);
+  if ((showClock.isRunning() || showJumpPending) && offset <= static_cast<int32_t>(FramePeriodMs) &&
+      -offset <= static_cast<int32_t>(FramePeriodMs))
+  {
+    return false;
+  }
+
+  queueShowOrigin(now - positionMs);
+  return true;
+}
+
+// Where the show is, counting a jump the render task has yet to apply.
+uint32_t showPosition(unsigned long now)
+{
+  return showJumpPending ? now - pendingShowOriginMs : showClock.position(now);
+}
+
+void queueShowOrigin(uint32_t originMs)
+{
+  pendingShowOriginMs = originMs;
+  showJumpPending = true;
+}
+
+void applyPendingShowJump()
+{
+  showJumpPending = false;
+  showClock.start(pendingShowOriginMs);
+}
+
+bool setLayout(const StripLayout &layout)
+{
+  const StripLayout &current = stripState.layout;
+  if (current.offset == layout.offset && current.reverse == layout.reverse &&
+      current.mirror == layout.mirror && current.group == layout.group &&
+      current.renderLength == layout.renderLength && current.interpolate == layout.interpolate)
+  {
+    return false;
+  }
+
+  stripState.layout = layout;
+  pendingLayout = layout;
+  layoutPending = true;
+  restartEffect();
+  return true;
+}
+
+// The flag is cleared before copying, so a change made meanwhile is applied
+// again next frame.
+void applyPendingLayout()
+{
+  layoutPending = false;
+  appliedLayout = pendingLayout;
+  rebuildPixelMap();
+}
+
+void rebuildPixelMap()
+{
+  PixelMapConfig config;
+  config.runs = ActiveRuns;
+  config.runCount = sizeof(ActiveRuns) / sizeof(ActiveRuns[0]);
+  config.deadPixels = DeadPixels;
+  config.deadCount = DeadPixelCount;
+  config.activeCount = pixelCount;
+  config.offset = appliedLayout.offset;
+  config.reverse = appliedLayout.reverse;
+  config.mirror = appliedLayout.mirror;
+  config.group = appliedLayout.group;
+  config.renderLength = appliedLayout.renderLength;
+  config.interpolate = appliedLayout.interpolate;
+  pixelMap.build(config);
+  geometry.build(pixelMap.logicalCount());
+  image.bind(geometry);
+  gif.bind(geometry);
+}
+
+// Output packing pass: one table lookup per physical LED, unmapped ones go dark.
+// A visible overlay is blended in here so the effect's frame stays untouched.
+void presentFrame()
+{
+  const bool overlayVisible = overlay.visible();
+  const OverlayRequest &overlayRequest = overlay.request();
+  const RgbColor overlayColor(overlayRequest.r, overlayRequest.g, overlayRequest.b);
+  const RgbColor *pixels = postChain.active() ? postFrame : (trailDecay ? trailFrame : frame);
+
+  if (!pixelMap.interpolates() && !overlayVisible)
+  {
+    for (uint16_t physical = 0; physical < MaxPixelCount; ++physical)
+    {
+      uint16_t source = pixelMap.sourceFor(physical);
+      strip.SetPixelColor(physical, source == PixelMap::Unmapped ? RgbColor(0) : pixels[source]);
+    }
+  }
+  else
+  {
+    for (uint16_t physical = 0; physical < MaxPixelCount; ++physical)
+    {
+      uint16_t source = pixelMap.sourceFor(physical);
+      if (source == PixelMap::Unmapped)
+      {
+        strip.SetPixelColor(physical, RgbColor(0));
+        continue;
+      }
+      uint8_t weight = pixelMap.blendFor(physical);
+      RgbColor color = weight ? RgbColor::LinearBlend(pixels[source], pixels[source + 1], weight) : pixels[source];
+      uint8_t alpha = overlayVisible ? overlay.alphaFor(source) : 0;
+      strip.SetPixelColor(physical, alpha ? RgbColor::LinearBlend(color, overlayColor, alpha) : color);
+    }
+  }
+  strip.Show();
+
+  if (overlayLatencyPending)
+  {
+    overlayLatencyUs = micros() - overlayTriggerUs;
+    overlayLatencyPending = false;
+  }
+}
+
+uint8_t brightnessLevel()
+{
+  return lut::Brightness[stripState.brightness]; // Gamma correction to make low values dimmer
+}
+
+// Peak channel value for fade targets; never fully dark unless brightness is 0.
+uint8_t fadeLevel()
+{
+  if (stripState.brightness == 0)
+  {
+    return 0;
+  }
+  return max<uint8_t>(1, brightnessLevel());
+}
+
+RgbColor applyBrightness(const RgbColor &color)
+{
+  return color.Dim(brightnessLevel());
+}
+
+uint32_t packColor(const RgbColor &color)
+{
+  return packed::pack(color.R, color.G, color.B);
+}
+
+RgbColor unpackColor(uint32_t color)
+{
+  return RgbColor(packed::red(color), packed::green(color), packed::blue(color));
+}
+
+// factor is 0-256, where 256 keeps the colour as it is.
+RgbColor scaleColor(const RgbColor &color, uint16_t factor)
+{
+  return unpackColor(packed::scale(packColor(color), factor));
+}
+
+void writeColorToActivePixels(const RgbColor &color)
+{
+  uint16_t count = pixelMap.logicalCount();
+  for (uint16_t pixel = 0; pixel < count; ++pixel)
+  {
+    frame[pixel] = color;
+  }
+}
+
+void invalidateFrame()
+{
+  frameDirty = true;
+}
+
+void restartEffect()
+{
+  restartPending = true;
+  frameDirty = true;
+}
 
+bool renderFade()
+{
+  if (!animations.IsAnimating())
+  {
+    FadeInFadeOutRinseRepeat(fadeLevel());
+  }
+  animations.UpdateAnimations();
+  return true;
+}
+
+bool renderSolid()
+{
+  writeColorToActivePixels(applyBrightness(stripState.solidColor));
+  return true;
+}
+
+bool renderOff()
+{
   writeColorToActivePixels(RgbColor(0));
-  for (uint8_t offset = 0; offset < SnakeSegmentLength; ++offset)
+  return true;
+}
+
+// Static warm white; while a temperature change is easing in it keeps its
+// frame dirty so it is redrawn each pass, then settles back to cached.
+bool renderWarm()
+{
+  unsigned long now = millis();
+  uint16_t kelvinNow = displayedKelvin(now);
+  if (kelvinNow != kelvinTo)
+  {
+    invalidateFrame();
+  }
+
+  lut::Rgb8 white = kelvin::toRgb(kelvinNow);
+  writeColorToActivePixels(applyBrightness(RgbColor(white.r, white.g, white.b)));
+  return true;
+}
+
+bool renderRainbow()
+{
+  CanvasSlice slice = canvasSlice();
+  uint8_t level = brightnessLevel();
+  effects::renderRainbow(slice.offset(), slice.count, slice.canvasCount(), [level](uint16_t pixel, const lut::Rgb8 &hue)
+                         { frame[pixel] = RgbColor(hue.r, hue.g, hue.b).Dim(level); });
+  return true;
+}
+
+void startShow()
+{
+  showPlayer.load(BuiltInShows[stripState.showIndex]);
+  if (!showClock.isRunning())
+  {
+    showClock.start(millis());
+  }
+  showFramePending = true;
+}
+
+// Plays the selected timeline as a solid color; the brightness slider scales
+// the show's own brightness track. Unchanged frames are not re-sent.
+bool renderShow()
+{
+  showPlayer.evaluate(showClock.position(millis()), showValues);
+
+  uint8_t level = (lut::Brightness[showValues[static_cast<uint8_t>(TimelineParam::Brightness)]] *
+                   (brightnessLevel() + 1)) >> 8;
+  RgbColor color = RgbColor(showValues[static_cast<uint8_t>(TimelineParam::Red)],
+                            showValues[static_cast<uint8_t>(TimelineParam::Green)],
+                            showValues[static_cast<uint8_t>(TimelineParam::Blue)])
+                       .Dim(level);
+  if (color == lastShowColor && !showFramePending)
+  {
+    return false;
+  }
+
+  lastShowColor = color;
+  showFramePending = false;
+  writeColorToActivePixels(color);
+  return true;
+}
+
+void startRadar()
+{
+  radar.restart();
+}
+
+void resizeRadar(uint16_t, uint16_t)
+{
+  radar.restart();
+}
+
+// The beam in the solid colour; following the beat, one turn per beat.
+bool renderRadar()
+{
+  if (!geometry.count())
   {
-    uint16_t pixel = snakeHead + offset;
-    if (pixel >= pixelCount)
+    return false;
+  }
+
+  uint16_t lead = stripState.beatSync && beatClock.isRunning() ? beatClock.phase() : effects::radarLead(millis());
+  uint32_t base = packColor(applyBrightness(stripState.solidColor));
+  radar.render(geometry, lead, [&](uint16_t pixel, uint8_t level)
+               { frame[pixel] = unpackColor(packed::dim(base, level)); });
+  return true;
+}
+
+// Either flag takes the staged scroll and spin; a finished upload also
+// swaps its texture in.
+void applyPendingImage()
+{
+  // Uploads are refused while a finish is pending, so only a set flag is
+  // cleared here and a new one cannot be lost.
+  bool finish = imageFinishPending;
+  if (finish)
+  {
+    imageFinishPending = false;
+  }
+  imageMotionPending = false;
+  stripState.imageScroll = pendingImageScroll;
+  stripState.imageSpinMs = pendingImageSpinMs;
+  if (finish && image.finish())
+  {
+    imageSavePending = true;
+  }
+  invalidateFrame();
+}
+
+void loadImage()
+{
+  File file = SPIFFS.open(ImagePath, "r");
+  if (!file)
+  {
+    return;
+  }
+
+  uint8_t size[2];
+  if (file.read(size, sizeof(size)) == sizeof(size) && image.begin(size[0], size[1]))
+  {
+    uint8_t chunk[256];
+    size_t offset = 0;
+    while (offset < image.uploadByteCount())
     {
-      break;
+      int count = file.read(chunk, sizeof(chunk));
+      if (count <= 0 || !image.write(offset, chunk, count))
+      {
+        break;
+      }
+      offset += count;
     }
+    if (offset == image.uploadByteCount())
+    {
+      image.finish();
+    }
+  }
+  file.close();
+}
 
-    float fade = 1.0f - (static_cast<float>(offset) / SnakeSegmentLength);
-    strip.SetPixelColor(pixel, scaleColor(baseColor, fade));
+void saveImage()
+{
+  File file = SPIFFS.open(ImagePath, "w");
+  if (!file)
+  {
+    Serial.println("Failed to save image");
+    return;
   }
+  uint8_t size[2] = {image.width(), image.height()};
+  file.write(size, sizeof(size));
+  file.write(image.bytes(), image.byteCount());
+  file.close();
+}
 
-  strip.Show();
+// Only closes and opens: the upload task wrote the new slot and the loop
+// removes the old one once it is closed.
+void applyPendingGif()
+{
+  gif.close();
+  gifFile.file.close();
+  gifSlot ^= 1;
+  gifRemovePending = true; // Before the swap flag clears, so uploads stay refused
+  gifReplacePending = false;
+  openGif();
+  invalidateFrame();
+}
+
+void removeOldGif()
+{
+  SPIFFS.remove(GifPaths[gifSlot ^ 1]);
+  gifRemovePending = false;
+}
 
-  snakeHead = (snakeHead + 1) % pixelCount;
+// At boot, the first slot holding a file. Both survive only a power cut
+// between a swap and the loop's removal; the first is then played.
+void chooseGifSlot()
+{
+  gifSlot = !SPIFFS.exists(GifPaths[0]) && SPIFFS.exists(GifPaths[1]) ? 1 : 0;
+  if (SPIFFS.exists(GifPaths[gifSlot ^ 1]))
+  {
+    SPIFFS.remove(GifPaths[gifSlot ^ 1]);
+  }
 }
 
-void ensureEffectIsRunning()
+bool openGif()
+{
+  gifFrameDueMs = 0;
+  gifDecodeUs = 0;
+  gifMaxDecodeUs = 0;
+  gifFile.file = SPIFFS.open(GifPaths[gifSlot], "r");
+  if (!gifFile.file)
+  {
+    return false;
+  }
+  if (!gif.open(gifFile))
+  {
+    gifFile.file.close();
+    Serial.println("Stored GIF is not playable");
+    return false;
+  }
+  return true;
+}
+
+// Samples the uploaded image at every pixel; scroll and spin only move the
+// precomputed sample positions.
+bool renderImage()
 {
-  switch (stripState.effect)
+  if (!image.loaded())
   {
-  case EffectMode::Fade:
-    offDirty = true;
-    solidDirty = true;
-    if (!animations.IsAnimating())
+    writeColorToActivePixels(RgbColor(0));
+    return true;
+  }
+
+  uint16_t count = pixelMap.logicalCount();
+  uint8_t level = brightnessLevel();
+  unsigned long now = millis();
+
+  if (stripState.imageSpinMs)
+  {
+    uint16_t rotation = static_cast<uint16_t>((now % stripState.imageSpinMs) * 65536UL / stripState.imageSpinMs);
+    for (uint16_t pixel = 0; pixel < count; ++pixel)
     {
-      FadeInFadeOutRinseRepeat(brightnessToLuminance());
+      lut::Rgb8 color = image.sampleRotated(pixel, rotation);
+      frame[pixel] = RgbColor(color.r, color.g, color.b).Dim(level);
     }
-    animations.UpdateAnimations();
-    strip.Show();
-    break;
+    return true;
+  }
+
+  int64_t span = static_cast<int64_t>(image.width()) << 8;
+  if (!span)
+  {
+    writeColorToActivePixels(RgbColor(0));
+    return true;
+  }
+  int64_t offset = (static_cast<int64_t>(now) * stripState.imageScroll * 256 / 1000) % span;
+  uint32_t scroll = static_cast<uint32_t>(offset < 0 ? offset + span : offset);
+  for (uint16_t pixel = 0; pixel < count; ++pixel)
+  {
+    lut::Rgb8 color = image.sampleScrolled(pixel, scroll);
+    frame[pixel] = RgbColor(color.r, color.g, color.b).Dim(level);
+  }
+  return true;
+}
+
+void startGif()
+{
+  gifFrameDueMs = 0;
+}
+
+// Decodes a GIF frame when its delay has passed; the decode is timed as part
+// of the frame, so maxDecodeUs shows how much of the budget a file needs.
+bool renderGif()
+{
+  if (!gif.isOpen())
+  {
+    writeColorToActivePixels(RgbColor(0));
+    return true;
+  }
+
+  unsigned long now = millis();
+  if (static_cast<long>(now - gifFrameDueMs) >= 0)
+  {
+    uint32_t startUs = micros();
+    gif.decodeFrame();
+    gifDecodeUs = micros() - startUs;
+    gifMaxDecodeUs = gifDecodeUs > gifMaxDecodeUs ? gifDecodeUs : gifMaxDecodeUs;
+    gifFrameDueMs = now + gif.frameDelayMs();
+  }
+
+  uint16_t count = pixelMap.logicalCount();
+  uint8_t level = brightnessLevel();
+  for (uint16_t pixel = 0; pixel < count; ++pixel)
+  {
+    lut::Rgb8 color = gif.sample(pixel);
+    frame[pixel] = RgbColor(color.r, color.g, color.b).Dim(level);
+  }
+  return true;
+}
+
+void startSnake()
+{
+  snakeHead = 0;
+  lastSnakeStepMs = 0;
+  if (!showClock.isRunning())
+  {
+    showClock.start(millis());
+  }
+  writeColorToActivePixels(RgbColor(0));
+}
+
+void resizeSnake(uint16_t oldCount, uint16_t newCount)
+{
+  snakeHead = oldCount ? static_cast<uint16_t>(static_cast<uint32_t>(snakeHead) * newCount / oldCount) : 0;
+  if (snakeHead >= newCount)
+  {
+    snakeHead = 0;
+  }
+}
+
+// The snake crawls along the whole canvas; each node draws the part that
+// falls on its slice.
+bool renderSnake()
+{
+  CanvasSlice slice = canvasSlice();
+  uint16_t count = static_cast<uint16_t>(slice.canvasCount());
+  if (count == 0)
+  {
+    return false;
+  }
 
-  case EffectMode::Solid:
-    if (animations.IsAnimating())
+  unsigned long now = millis();
+  if (stripState.beatSync && beatClock.isRunning())
+  {
+    // Step on each quarter of the beat.
+    uint32_t step = beatClock.beat() * SnakeStepsPerBeat + (beatClock.phase() * SnakeStepsPerBeat >> 16);
+    if (step == lastSnakeBeatStep && lastSnakeStepMs)
     {
-      animations.StopAll();
+      return false;
     }
-    if (solidDirty)
+    lastSnakeBeatStep = step;
+  }
+  else if (slice.partitioned())
+  {
+    // Each node takes the head from the show clock rather than counting its
+    // own steps, so the snake crosses from node to node in step.
+    uint32_t step = showClock.position(now) / SnakeStepDelayMs;
+    if (step == lastSnakeClockStep && lastSnakeStepMs)
     {
-      applySolidColor();
+      return false;
     }
-    break;
+    lastSnakeClockStep = step;
+    snakeHead = static_cast<uint16_t>(step % count);
+  }
+  else if (lastSnakeStepMs && now - lastSnakeStepMs < SnakeStepDelayMs)
+  {
+    return false;
+  }
+
+  lastSnakeStepMs = now;
+  RgbColor baseColor = applyBrightness(stripState.solidColor);
+
+  writeColorToActivePixels(RgbColor(0));
+  for (uint8_t offset = 0; offset < SnakeSegmentLength; ++offset)
+  {
+    uint32_t pixel = snakeHead + offset;
+    if (pixel >= count)
+    {
+      break;
+    }
+    if (pixel < slice.offset() || pixel >= slice.offset() + slice.count)
+    {
+      continue;
+    }
+
+    uint16_t fade = 256 - offset * 256 / SnakeSegmentLength;
+    frame[pixel - slice.offset()] = scaleColor(baseColor, fade);
+  }
+
+  snakeHead = (snakeHead + 1) % count;
+  return true;
+}
 
-  case EffectMode::Snake:
-    if (animations.IsAnimating())
+// Streamed pixels are in logical order, like an effect's; pixels the
+// stream doesn't cover go dark. When the stream has been quiet for
+// StreamTimeoutMs the local effect restarts.
+bool applyPendingStream(unsigned long now)
+{
+  if (streamPending)
+  {
+    uint16_t count = pixelMap.logicalCount();
+    uint16_t streamed = min<uint16_t>(pendingStreamLength / 3, count);
+    const uint8_t *rgb = pendingStream;
+    for (uint16_t pixel = 0; pixel < count; ++pixel, rgb += 3)
     {
-      animations.StopAll();
+      frame[pixel] = pixel < streamed ? RgbColor(rgb[0], rgb[1], rgb[2]) : RgbColor(0);
     }
-    offDirty = true;
-    solidDirty = true;
-    runSnakeEffect();
-    break;
+    streamPending = false;
+    streaming = true;
+    lastStreamMs = now;
+    ++streamFrames;
+    return true;
+  }
+
+  if (streaming && now - lastStreamMs >= StreamTimeoutMs)
+  {
+    streaming = false;
+    ++streamFallbacks;
+    restartEffect();
+  }
+  return false;
+}
+
+void ensureEffectIsRunning()
+{
+  // Ahead of the restart a layout change queues, so it sees the new map.
+  if (layoutPending)
+  {
+    applyPendingLayout();
+  }
+
+  if (seedPending)
+  {
+    applyPendingSeed();
+  }
+
+  if (kelvinPending)
+  {
+    applyPendingKelvin();
+  }
+
+  // Before the restart, so a newly selected show starts from its origin.
+  if (showJumpPending)
+  {
+    applyPendingShowJump();
+  }
 
-  case EffectMode::Off:
-    if (animations.IsAnimating())
+  // Checked first, so a fallback restarts the effect before it renders.
+  bool streamChanged = applyPendingStream(millis());
+
+  // The mode is read after the flag is cleared, so a change landing
+  // meanwhile queues another restart rather than being lost.
+  if (restartPending)
+  {
+    restartPending = false;
+    runningEffect = stripState.effect;
+    animations.StopAll();
+    const EffectDefinition &started = effectFor(runningEffect);
+    if (started.start)
     {
-      animations.StopAll();
+      started.start();
     }
-    if (offDirty)
+  }
+  const EffectDefinition &effect = effectFor(runningEffect);
+
+  if (pixelCountPending)
+  {
+    applyPixelCount();
+  }
+
+  if (imageFinishPending || imageMotionPending)
+  {
+    applyPendingImage();
+  }
+
+  if (gifReplacePending)
+  {
+    applyPendingGif();
+  }
+
+  // Beat phase is sampled once per frame so every effect sees the same value.
+  applyPendingTempo();
+  beatClock.update(millis());
+
+  if (overlayPending)
+  {
+    overlayPending = false;
+    overlay.trigger(pendingOverlay, millis());
+    overlayLatencyPending = true;
+  }
+  bool overlayChanged = overlay.advance(millis(), pixelMap.logicalCount());
+
+  // Static effects keep their cached frame until a parameter changes; the
+  // flag is cleared before rendering so a change made meanwhile is not lost.
+  // A stream stands in for the effect; trails, post and overlays still apply.
+  bool frameChanged = streamChanged;
+  if (!streaming && (effect.animated || frameDirty))
+  {
+    bool forcePresent = frameDirty;
+    frameDirty = false;
+    frameChanged = effect.render() || forcePresent;
+  }
+
+  // Trails keep presenting after the effect goes still, until they fade out.
+  if (stripState.trails != trailDecay)
+  {
+    if (!trailDecay)
     {
-      turnStripOff();
+      for (RgbColor &color : trailFrame)
+      {
+        color = RgbColor(0);
+      }
     }
-    break;
+    trailDecay = stripState.trails;
+  }
+  bool trailsChanged = trailDecay && (frameChanged || trailsFading);
+  if (trailsChanged)
+  {
+    trailsFading = trails::fold(frame, trailFrame, pixelMap.logicalCount(), trailDecay);
+  }
+
+  bool postChanged = postPending;
+  if (postPending)
+  {
+    // Cleared before copying, like the layout; a torn spec fails to parse
+    // and the chain keeps its stages until the next frame retries.
+    postPending = false;
+    char spec[PostChain::MaxSpecLength + 1];
+    memcpy(spec, pendingPost, sizeof(spec));
+    spec[sizeof(spec) - 1] = '\0';
+    postChain.configure(spec, pendingPostStrength);
+  }
+
+  // On a partitioned canvas the chain filters across the seams with the
+  // neighbours' edges; a changed or expired edge re-filters this slice.
+  const RgbColor *postInput = trailDecay ? trailFrame : frame;
+  CanvasSlice slice = canvasSlice();
+  bool haloChanged = false;
+  if (postChain.active() && slice.partitioned())
+  {
+    haloChanged = exchangeHalos(slice, postInput, frameChanged || trailsChanged || postChanged);
+  }
+  if (postChain.active() && (frameChanged || trailsChanged || postChanged || haloChanged))
+  {
+    const bool partitioned = slice.partitioned();
+    uint32_t startUs = micros();
+    postChain.apply(postInput, postFrame, slice.count, partitioned ? halos.left() : nullptr,
+                    partitioned ? halos.right() : nullptr);
+    postUs = micros() - startUs;
+  }
+
+  if (frameChanged || overlayChanged || trailsChanged || postChanged || haloChanged)
+  {
+    presentFrame();
   }
 }
 
-void SetRandomSeed()
+// Broadcasts this node's edges when they changed, and every few frames
+// regardless so a neighbour that restarts gets them; then takes whatever the
+// neighbours sent. True if the halos the chain will read changed.
+bool exchangeHalos(const CanvasSlice &slice, const RgbColor *pixels, bool edgesChanged)
 {
-  uint32_t seed = analogRead(0);
-  delay(1);
-  for (int shifts = 3; shifts < 31; shifts += 3)
+  if (edgesChanged || ++haloIdleFrames >= HaloRefreshFrames)
   {
-    seed ^= analogRead(0) << shifts;
-    delay(1);
+    uint8_t packet[HaloExchange::PacketSize];
+    size_t length = HaloExchange::encode(slice, haloSequence++, pixels, packet);
+    haloSendUdp.beginPacket(IPAddress(255, 255, 255, 255), HaloUdpPort);
+    haloSendUdp.write(packet, length);
+    haloSendUdp.endPacket();
+    haloIdleFrames = 0;
+  }
+
+  bool changed = halos.advance();
+  for (uint8_t index = 0; index < 2; ++index)
+  {
+    if (haloPending[index])
+    {
+      changed |= halos.receive(slice, pendingHalo[index], HaloExchange::PacketSize);
+      haloPending[index] = false;
+    }
   }
-  randomSeed(seed);
+  return changed;
+}
+
+void SetRandomSeed()
+{
+  // The ESP32 hardware RNG is ready immediately; no need to sample a floating pin.
+  fadeRandom.reseed(esp_random());
 }
 
 void BlendAnimUpdate(const AnimationParam &param)
 {
+  // Ease once per frame; the whole strip shares the blended color.
   RgbColor updatedColor = RgbColor::LinearBlend(
       fadeChannels[param.index].StartingColor,
       fadeChannels[param.index].EndingColor,
-      param.progress);
+      easing::ease(stripState.fadeEasing, param.progress));
 
   // Only update if in fade mode to prevent interference
-  if (stripState.effect == EffectMode::Fade)
+  if (runningEffect == EffectMode::Fade)
   {
     writeColorToActivePixels(updatedColor);
   }
 }
 
-void FadeInFadeOutRinseRepeat(float luminance)
+void FadeInFadeOutRinseRepeat(uint8_t level)
 {
   // Generate a new random color target
-  RgbColor target = HslColor(random(360) / 360.0f, 1.0f, luminance);
+  const lut::Rgb8 &hue = lut::HueWheel[fadeRandom.below(256)];
+  RgbColor target = RgbColor(hue.r, hue.g, hue.b).Dim(level);
 
   // Use longer, smoother fade times for gentle color transitions
-  uint16_t time = random(2000, 4000);
+  uint16_t time = fadeRandom.between(2000, 4000);
+  if (stripState.beatSync && beatClock.isRunning())
+  {
+    // Land each new color on a beat.
+    time = min<uint32_t>(FadeBeats * beatClock.periodMs(), 60000);
+  }
 
   // Always start from the current ending color for smooth blending
   if (animations.IsAnimating())
@@ -519,8 +2875,8 @@ void FadeInFadeOutRinseRepeat(float luminance)
   else
   {
     // First time or animation just finished, use the current displayed color
-    // Read from the strip to get the actual current color
-    RgbColor currentColor = strip.GetPixelColor(0);
+    // Read from the frame to get the actual current color
+    RgbColor currentColor = frame[0];
     fadeChannels[0].StartingColor = currentColor;
   }
 
@@ -0,0 +1,70 @@
+#include "osc_message.h"
+
+#include <string.h>
+
+namespace
+{
+  // OSC strings are NUL-terminated and padded to a multiple of four bytes.
+  size_t paddedStringLength(const uint8_t *data, size_t available)
+  {
+    const void *end = memchr(data, 0, available);
+    if (!end)
+    {
+      return 0;
+    }
+    size_t length = static_cast<const uint8_t *>(end) - data + 1;
+    length = (length + 3) & ~static_cast<size_t>(3);
+    return length <= available ? length : 0;
+  }
+
+  uint32_t readBigEndian32(const uint8_t *data)
+  {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | data[3];
+  }
+}
+
+bool parseOscMessage(const uint8_t *packet, size_t length, OscMessage &message)
+{
+  message = OscMessage();
+  if (length < 4 || packet[0] != '/')
+  {
+    return false;
+  }
+
+  size_t addressLength = paddedStringLength(packet, length);
+  if (!addressLength)
+  {
+    return false;
+  }
+  message.address = reinterpret_cast<const char *>(packet);
+
+  size_t offset = addressLength;
+  if (offset == length)
+  {
+    return true; // No type tag: message without arguments
+  }
+
+  size_t tagLength = paddedStringLength(packet + offset, length - offset);
+  if (!tagLength || packet[offset] != ',')
+  {
+    return false;
+  }
+  char type = static_cast<char>(packet[offset + 1]);
+  offset += tagLength;
+
+  if ((type == 'i' || type == 'f') && offset + 4 <= length)
+  {
+    uint32_t raw = readBigEndian32(packet + offset);
+    if (type == 'i')
+    {
+      message.argument = static_cast<float>(static_cast<int32_t>(raw));
+    }
+    else
+    {
+      memcpy(&message.argument, &raw, sizeof(raw));
+    }
+    message.hasArgument = true;
+  }
+  return true;
+}
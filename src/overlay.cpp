@@ -0,0 +1,80 @@
+#include "overlay.h"
+
+#include <string.h>
+
+#include "easing.h"
+#include "lookup_tables.h"
+
+void Overlay::trigger(const OverlayRequest &request, uint32_t nowMs)
+{
+  current = request;
+  if (current.ttlMs == 0)
+  {
+    current.ttlMs = 1;
+  }
+  if (current.ttlMs > MaxTtlMs)
+  {
+    current.ttlMs = MaxTtlMs;
+  }
+  startMs = nowMs;
+  active = current.kind != OverlayKind::None;
+}
+
+bool Overlay::advance(uint32_t nowMs, uint16_t logicalCount)
+{
+  if (!active)
+  {
+    return false;
+  }
+
+  uint32_t elapsed = nowMs - startMs;
+  if (elapsed >= current.ttlMs)
+  {
+    active = false;
+    alpha = 0;
+    coverEnd = 0;
+    return true; // One more frame to restore the base effect
+  }
+
+  uint8_t progress = static_cast<uint8_t>((elapsed * 255) / current.ttlMs);
+  coverEnd = logicalCount;
+  switch (current.kind)
+  {
+  case OverlayKind::Flash:
+    alpha = 255 - easing::ease(Easing::OutQuad, progress);
+    break;
+  case OverlayKind::Pulse:
+    // First half of the sine period: 0 -> peak -> 0.
+    alpha = static_cast<uint8_t>((lut::sin8(progress >> 1) - 128) * 2);
+    break;
+  case OverlayKind::Wipe:
+    alpha = 255;
+    coverEnd = static_cast<uint16_t>((static_cast<uint32_t>(progress) + 1) * logicalCount / 256);
+    break;
+  default:
+    alpha = 0;
+    break;
+  }
+  return true;
+}
+
+bool overlayKindFromName(const char *name, OverlayKind &kind)
+{
+  if (strcmp(name, "flash") == 0)
+  {
+    kind = OverlayKind::Flash;
+  }
+  else if (strcmp(name, "wipe") == 0)
+  {
+    kind = OverlayKind::Wipe;
+  }
+  else if (strcmp(name, "pulse") == 0)
+  {
+    kind = OverlayKind::Pulse;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
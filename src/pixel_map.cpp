@@ -0,0 +1,109 @@
+#include "pixel_map.h"
+
+namespace
+{
+  bool isDead(const PixelMapConfig &config, uint16_t physical)
+  {
+    for (uint8_t i = 0; i < config.deadCount; ++i)
+    {
+      if (config.deadPixels[i] == physical)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  uint16_t renderedCount(const PixelMapConfig &config, uint16_t mappedCount)
+  {
+    if (config.renderLength)
+    {
+      return config.renderLength < mappedCount ? config.renderLength : mappedCount;
+    }
+    uint8_t group = config.group ? config.group : 1;
+    return (mappedCount + group - 1) / group;
+  }
+
+  // Keeps an 8.8 sample position inside the rendered pixels so the blend
+  // partner (index + 1) always exists.
+  int32_t clampSample(int32_t sample, uint16_t logicalPixels)
+  {
+    if (sample < 0)
+    {
+      return 0;
+    }
+    int32_t last = static_cast<int32_t>(logicalPixels - 1) << 8;
+    return sample > last ? last : sample;
+  }
+}
+
+void PixelMap::build(const PixelMapConfig &config)
+{
+  // Walk the wiring once to get the live LEDs in spiral order.
+  uint16_t spiralOrder[MaxPixelCount];
+  uint16_t liveCount = 0;
+
+  const PixelRun wholeStrip = {0, MaxPixelCount, false};
+  const PixelRun *runs = config.runs ? config.runs : &wholeStrip;
+  const uint8_t runCount = config.runs ? config.runCount : 1;
+
+  for (uint8_t run = 0; run < runCount; ++run)
+  {
+    for (uint16_t step = 0; step < runs[run].length; ++step)
+    {
+      uint16_t physical = runs[run].reversed
+                              ? runs[run].start + runs[run].length - 1 - step
+                              : runs[run].start + step;
+      if (physical >= config.activeCount || physical >= MaxPixelCount ||
+          isDead(config, physical) || liveCount >= MaxPixelCount)
+      {
+        continue;
+      }
+      spiralOrder[liveCount++] = physical;
+    }
+  }
+
+  for (uint16_t physical = 0; physical < MaxPixelCount; ++physical)
+  {
+    physicalToLogical[physical] = Unmapped;
+    blendWeight[physical] = 0;
+  }
+
+  const uint16_t mappedCount = config.mirror ? (liveCount + 1) / 2 : liveCount;
+  logicalPixels = renderedCount(config, mappedCount);
+  interpolating = config.interpolate && logicalPixels < mappedCount;
+  if (logicalPixels == 0)
+  {
+    return;
+  }
+
+  // Fold, flip and rotate in spiral space so the table stays one lookup deep.
+  for (uint16_t position = 0; position < liveCount; ++position)
+  {
+    uint16_t mapped = position;
+    if (config.mirror && mapped >= mappedCount)
+    {
+      mapped = liveCount - 1 - mapped;
+    }
+    if (config.reverse)
+    {
+      mapped = mappedCount - 1 - mapped;
+    }
+    mapped = (mapped + config.offset) % mappedCount;
+
+    // Sample the rendered pixels at this LED's centre, in 8.8 fixed point.
+    int32_t sample = ((2 * static_cast<int32_t>(mapped) + 1) * logicalPixels * 256) / (2 * mappedCount);
+    uint16_t physical = spiralOrder[position];
+    if (!interpolating)
+    {
+      // Plain grouping keeps whole runs of N LEDs together.
+      bool grouped = !config.renderLength && config.group > 1;
+      physicalToLogical[physical] = grouped ? mapped / config.group : static_cast<uint16_t>(sample >> 8);
+      continue;
+    }
+
+    sample = clampSample(sample - 128, logicalPixels);
+    physicalToLogical[physical] = static_cast<uint16_t>(sample >> 8);
+    blendWeight[physical] = static_cast<uint8_t>(sample & 0xFF);
+  }
+}
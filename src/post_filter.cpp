@@ -0,0 +1,187 @@
+#include "post_filter.h"
+
+#include <string.h>
+
+namespace
+{
+  // Binomial blurs in 1/256, indexed by taps / 2 - 1.
+  constexpr int16_t Binomial[3][PostChain::MaxTaps] = {
+      {64, 128, 64},
+      {16, 64, 96, 64, 16},
+      {4, 24, 60, 80, 60, 24, 4},
+  };
+
+  constexpr const char *KindNames[] = {"blur", "glow", "sharpen"};
+
+  int16_t clampChannel(int32_t value)
+  {
+    value = value < 0 ? 0 : value;
+    return static_cast<int16_t>(value > 255 ? 255 : value);
+  }
+}
+
+bool PostChain::configure(const char *spec, uint8_t strength)
+{
+  Kind kinds[MaxStages];
+  uint8_t taps[MaxStages];
+  uint8_t count;
+  if (!parse(spec, kinds, taps, count))
+  {
+    return false;
+  }
+
+  for (uint8_t index = 0; index < count; ++index)
+  {
+    buildStage(stages[index], kinds[index], taps[index], strength);
+  }
+  stageCount = count;
+  amount = strength;
+  strcpy(text, count ? spec : "off");
+  return true;
+}
+
+bool PostChain::valid(const char *spec)
+{
+  Kind kinds[MaxStages];
+  uint8_t taps[MaxStages];
+  uint8_t count;
+  return parse(spec, kinds, taps, count);
+}
+
+uint8_t PostChain::tapCount() const
+{
+  uint8_t total = 0;
+  for (uint8_t index = 0; index < stageCount; ++index)
+  {
+    total += stages[index].taps;
+  }
+  return total;
+}
+
+// Stages are "<kind><taps>", e.g. "glow5", joined by '+'.
+bool PostChain::parse(const char *spec, Kind *kinds, uint8_t *taps, uint8_t &count)
+{
+  count = 0;
+  if (strlen(spec) > MaxSpecLength)
+  {
+    return false;
+  }
+  if (!*spec || strcmp(spec, "off") == 0)
+  {
+    return true;
+  }
+
+  const char *cursor = spec;
+  for (;;)
+  {
+    constexpr uint8_t KindCount = sizeof(KindNames) / sizeof(KindNames[0]);
+    uint8_t index = 0;
+    size_t length = 0;
+    for (; index < KindCount; ++index)
+    {
+      length = strlen(KindNames[index]);
+      if (strncmp(cursor, KindNames[index], length) == 0)
+      {
+        break;
+      }
+    }
+    // Only a matched name is known to lie within the string; the size digit
+    // after it may be the terminator ("blur").
+    if (count == MaxStages || index == KindCount)
+    {
+      return false;
+    }
+    char digit = cursor[length];
+    if (digit != '3' && digit != '5' && digit != '7')
+    {
+      return false;
+    }
+    kinds[count] = static_cast<Kind>(index);
+    taps[count++] = static_cast<uint8_t>(digit - '0');
+
+    cursor += length + 1;
+    if (!*cursor)
+    {
+      return true;
+    }
+    if (*cursor++ != '+')
+    {
+      return false;
+    }
+  }
+}
+
+// Glow and sharpen scale the blur by strength/256 and add or subtract it
+// around the centre tap; sharpen's centre absorbs the rounding so flat
+// areas keep their level exactly.
+void PostChain::buildStage(Stage &stage, Kind kind, uint8_t taps, uint8_t strength)
+{
+  const int16_t *blur = Binomial[taps / 2 - 1];
+  const uint8_t centre = taps / 2;
+  stage.taps = taps;
+  memset(stage.weights, 0, sizeof(stage.weights));
+
+  if (kind == Kind::Blur)
+  {
+    memcpy(stage.weights, blur, sizeof(int16_t) * taps);
+    return;
+  }
+
+  int16_t scaledSum = 0;
+  for (uint8_t tap = 0; tap < taps; ++tap)
+  {
+    int16_t scaled = static_cast<int16_t>((blur[tap] * strength + 128) >> 8);
+    stage.weights[tap] = kind == Kind::Glow ? scaled : -scaled;
+    scaledSum += scaled;
+  }
+  stage.weights[centre] += kind == Kind::Glow ? 256 : 256 + scaledSum;
+}
+
+// Ping-pongs between the two line buffers; returns the last one written.
+// [low, high] is the span of valid pixels. A side without a halo repeats its
+// end pixel into the padding before each stage; on a side with one, each
+// stage is also computed over the halo pixels it still has a full window
+// for, so the next stage reads filtered neighbours, not raw ones.
+const int16_t *PostChain::run(uint16_t count, bool leftHalo, bool rightHalo)
+{
+  int16_t *source = lines[0];
+  int16_t *target = lines[1];
+  const uint16_t first = HaloWidth;
+  const uint16_t last = HaloWidth + count - 1;
+  uint16_t low = leftHalo ? 0 : first;
+  uint16_t high = rightHalo ? last + HaloWidth : last;
+  for (uint8_t index = 0; index < stageCount; ++index)
+  {
+    const Stage &stage = stages[index];
+    const uint8_t half = stage.taps / 2;
+    for (uint8_t pad = 1; pad <= half; ++pad)
+    {
+      if (!leftHalo)
+      {
+        source[first - pad] = source[first];
+      }
+      if (!rightHalo)
+      {
+        source[last + pad] = source[last];
+      }
+    }
+    low += leftHalo ? half : 0;
+    high -= rightHalo ? half : 0;
+
+    const int16_t *window = source + low - half;
+    for (uint16_t pixel = low; pixel <= high; ++pixel, ++window)
+    {
+      int32_t sum = 128;
+      for (uint8_t tap = 0; tap < stage.taps; ++tap)
+      {
+        sum += stage.weights[tap] * window[tap];
+      }
+      target[pixel] = clampChannel(sum >> 8);
+    }
+
+    int16_t *swap = source;
+    source = target;
+    target = swap;
+  }
+  return source + HaloWidth;
+}
@@ -0,0 +1,48 @@
+/*
+ * Built-in shows. Times are milliseconds from the show start.
+ */
+
+#include "timeline.h"
+
+namespace
+{
+  constexpr uint32_t Minutes = 60000;
+
+  // Sunrise: indigo pre-dawn glow, through deep red and amber, to warm daylight
+  // over half an hour, then holds.
+  const Keyframe SunriseBrightness[] = {
+      {0, 0, curveOf(Easing::InQuad)},
+      {10 * Minutes, 70, curveOf(Easing::InOutSine)},
+      {20 * Minutes, 170, curveOf(Easing::OutQuad)},
+      {30 * Minutes, 255, curveOf(KeyCurve::Step)},
+  };
+  const Keyframe SunriseRed[] = {
+      {0, 60, curveOf(Easing::OutQuad)},
+      {8 * Minutes, 255, curveOf(KeyCurve::Step)},
+  };
+  const Keyframe SunriseGreen[] = {
+      {0, 0, curveOf(Easing::InQuad)},
+      {12 * Minutes, 40, curveOf(Easing::InOutSine)},
+      {22 * Minutes, 140, curveOf(Easing::InOutSine)},
+      {30 * Minutes, 210, curveOf(KeyCurve::Step)},
+  };
+  const Keyframe SunriseBlue[] = {
+      {0, 90, curveOf(Easing::InOutSine)},
+      {8 * Minutes, 0, curveOf(KeyCurve::Step)},
+      {20 * Minutes, 0, curveOf(Easing::InQuad)},
+      {30 * Minutes, 140, curveOf(KeyCurve::Step)},
+  };
+
+  const TimelineTrack SunriseTracks[] = {
+      {TimelineParam::Brightness, sizeof(SunriseBrightness) / sizeof(Keyframe), SunriseBrightness},
+      {TimelineParam::Red, sizeof(SunriseRed) / sizeof(Keyframe), SunriseRed},
+      {TimelineParam::Green, sizeof(SunriseGreen) / sizeof(Keyframe), SunriseGreen},
+      {TimelineParam::Blue, sizeof(SunriseBlue) / sizeof(Keyframe), SunriseBlue},
+  };
+
+  const Timeline Sunrise = {"sunrise", 30 * Minutes, false,
+                            sizeof(SunriseTracks) / sizeof(TimelineTrack), SunriseTracks};
+}
+
+const Timeline *const BuiltInShows[] = {&Sunrise};
+const uint8_t BuiltInShowCount = sizeof(BuiltInShows) / sizeof(BuiltInShows[0]);
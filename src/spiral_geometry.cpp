@@ -0,0 +1,86 @@
+#include "spiral_geometry.h"
+
+#include <math.h>
+
+namespace
+{
+  // Insertion sort: runs only on layout changes and the radius order is
+  // already sorted for a spiral, so it is linear there.
+  template <typename Key>
+  void sortBy(uint16_t *order, uint16_t count, Key key)
+  {
+    for (uint16_t i = 0; i < count; ++i)
+    {
+      order[i] = i;
+    }
+    for (uint16_t i = 1; i < count; ++i)
+    {
+      uint16_t pixel = order[i];
+      uint16_t j = i;
+      for (; j > 0 && key(order[j - 1]) > key(pixel); --j)
+      {
+        order[j] = order[j - 1];
+      }
+      order[j] = pixel;
+    }
+  }
+
+  template <typename Key>
+  uint16_t lowerBound(const uint16_t *order, uint16_t count, uint16_t value, Key key)
+  {
+    uint16_t low = 0;
+    uint16_t high = count;
+    while (low < high)
+    {
+      uint16_t middle = (low + high) / 2;
+      if (key(order[middle]) < value)
+      {
+        low = middle + 1;
+      }
+      else
+      {
+        high = middle;
+      }
+    }
+    return low;
+  }
+}
+
+void SpiralGeometry::build(uint16_t logicalCount)
+{
+  pointCount = logicalCount < MaxPixelCount ? logicalCount : MaxPixelCount;
+
+  // r(theta) = a + b * theta, so arc length s(theta) = a * theta + b * theta^2 / 2;
+  // invert it to place pixels at equal arc-length steps.
+  const float totalAngle = 2.0f * static_cast<float>(M_PI) * SpiralTurns;
+  const float a = SpiralInnerRadius / 255.0f;
+  const float b = (1.0f - a) / totalAngle;
+  const float length = a * totalAngle + b * totalAngle * totalAngle / 2.0f;
+
+  for (uint16_t pixel = 0; pixel < pointCount; ++pixel)
+  {
+    float s = (pixel + 0.5f) * length / pointCount;
+    float theta = (sqrtf(a * a + 2.0f * b * s) - a) / b;
+    float turns = theta / (2.0f * static_cast<float>(M_PI));
+
+    points[pixel].angle = static_cast<uint16_t>(static_cast<uint32_t>((turns - floorf(turns)) * 65536.0f));
+    points[pixel].radius = static_cast<uint8_t>(lroundf((a + b * theta) * 255.0f));
+  }
+
+  sortBy(angleOrder, pointCount, [this](uint16_t pixel)
+         { return points[pixel].angle; });
+  sortBy(radiusOrder, pointCount, [this](uint16_t pixel)
+         { return points[pixel].radius; });
+}
+
+uint16_t SpiralGeometry::angleRank(uint16_t angle) const
+{
+  return lowerBound(angleOrder, pointCount, angle, [this](uint16_t pixel)
+                    { return points[pixel].angle; });
+}
+
+uint16_t SpiralGeometry::radiusRank(uint8_t radius) const
+{
+  return lowerBound(radiusOrder, pointCount, radius, [this](uint16_t pixel)
+                    { return points[pixel].radius; });
+}
@@ -0,0 +1,158 @@
+#include "spiral_image.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+  constexpr float TwoPi = 2.0f * static_cast<float>(M_PI);
+
+  lut::Rgb8 blend(const lut::Rgb8 &c00, const lut::Rgb8 &c10, const lut::Rgb8 &c01, const lut::Rgb8 &c11,
+                  uint8_t fx, uint8_t fy)
+  {
+    auto mix = [fx, fy](uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+      uint32_t top = a * (256u - fx) + b * fx;
+      uint32_t bottom = c * (256u - fx) + d * fx;
+      return static_cast<uint8_t>((top * (256u - fy) + bottom * fy) >> 16);
+    };
+    return {mix(c00.r, c10.r, c01.r, c11.r), mix(c00.g, c10.g, c01.g, c11.g), mix(c00.b, c10.b, c01.b, c11.b)};
+  }
+
+  uint16_t toFixed(float value)
+  {
+    return static_cast<uint16_t>(lroundf(value * 256.0f));
+  }
+}
+
+bool SpiralImage::begin(uint8_t width, uint8_t height)
+{
+  if (!width || !height || width > MaxSide || height > MaxSide)
+  {
+    stagedWidth = stagedHeight = 0;
+    return false;
+  }
+  stagedWidth = width;
+  stagedHeight = height;
+  return true;
+}
+
+bool SpiralImage::write(size_t offset, const uint8_t *data, size_t length)
+{
+  if (offset > uploadByteCount() || length > uploadByteCount() - offset)
+  {
+    return false;
+  }
+  memcpy(staged + offset, data, length);
+  return true;
+}
+
+bool SpiralImage::finish()
+{
+  if (!stagedWidth)
+  {
+    return false;
+  }
+  memcpy(pixels, staged, uploadByteCount());
+  imageWidth = stagedWidth;
+  imageHeight = stagedHeight;
+
+  for (uint8_t ring = 0; ring < PolarRadii; ++ring)
+  {
+    float radius = (ring + 0.5f) / PolarRadii;
+    for (uint16_t step = 0; step < PolarAngles; ++step)
+    {
+      float theta = TwoPi * step / PolarAngles;
+      polar[ring][step] = sampleImage(radius * cosf(theta), radius * sinf(theta));
+    }
+  }
+
+  placeTaps();
+  ready = true;
+  return true;
+}
+
+void SpiralImage::bind(const SpiralGeometry &geometry)
+{
+  tapCount = geometry.count();
+  for (uint16_t pixel = 0; pixel < tapCount; ++pixel)
+  {
+    positions[pixel] = geometry.point(pixel);
+  }
+  placeTaps();
+}
+
+// The image's shorter side spans the spiral's outer diameter, centred.
+void SpiralImage::placeTaps()
+{
+  if (!imageWidth)
+  {
+    return;
+  }
+
+  const float centreX = (imageWidth - 1) / 2.0f;
+  const float centreY = (imageHeight - 1) / 2.0f;
+  const float half = ((imageWidth < imageHeight ? imageWidth : imageHeight) - 1) / 2.0f;
+
+  for (uint16_t pixel = 0; pixel < tapCount; ++pixel)
+  {
+    const PolarPoint &point = positions[pixel];
+    float radius = point.radius / 255.0f;
+    float theta = TwoPi * point.angle / 65536.0f;
+
+    Tap &tap = taps[pixel];
+    tap.x = toFixed(centreX + radius * cosf(theta) * half);
+    tap.y = toFixed(centreY - radius * sinf(theta) * half);
+
+    float ring = radius * PolarRadii - 0.5f;
+    ring = ring < 0.0f ? 0.0f : (ring > PolarRadii - 1 ? PolarRadii - 1 : ring);
+    tap.angle = static_cast<uint16_t>((static_cast<uint32_t>(point.angle) * PolarAngles) >> 8);
+    tap.radius = toFixed(ring);
+  }
+}
+
+lut::Rgb8 SpiralImage::texel(uint8_t x, uint8_t y) const
+{
+  const uint8_t *rgb = pixels + (static_cast<size_t>(y) * imageWidth + x) * 3;
+  return {rgb[0], rgb[1], rgb[2]};
+}
+
+// Upload-time only: (u, v) on the unit circle, y up.
+lut::Rgb8 SpiralImage::sampleImage(float u, float v) const
+{
+  const float half = ((imageWidth < imageHeight ? imageWidth : imageHeight) - 1) / 2.0f;
+  float x = (imageWidth - 1) / 2.0f + u * half;
+  float y = (imageHeight - 1) / 2.0f - v * half;
+
+  uint8_t x0 = static_cast<uint8_t>(x);
+  uint8_t y0 = static_cast<uint8_t>(y);
+  uint8_t x1 = x0 + 1 < imageWidth ? x0 + 1 : x0;
+  uint8_t y1 = y0 + 1 < imageHeight ? y0 + 1 : y0;
+  uint8_t fx = static_cast<uint8_t>((x - x0) * 255.0f);
+  uint8_t fy = static_cast<uint8_t>((y - y0) * 255.0f);
+  return blend(texel(x0, y0), texel(x1, y0), texel(x0, y1), texel(x1, y1), fx, fy);
+}
+
+lut::Rgb8 SpiralImage::sampleScrolled(uint16_t logical, uint32_t scroll) const
+{
+  const Tap &tap = taps[logical];
+  uint32_t x = (tap.x + scroll) % (static_cast<uint32_t>(imageWidth) << 8);
+
+  uint8_t x0 = x >> 8;
+  uint8_t x1 = x0 + 1 < imageWidth ? x0 + 1 : 0; // Scrolling wraps round
+  uint8_t y0 = tap.y >> 8;
+  uint8_t y1 = y0 + 1 < imageHeight ? y0 + 1 : y0;
+  return blend(texel(x0, y0), texel(x1, y0), texel(x0, y1), texel(x1, y1), x & 0xFF, tap.y & 0xFF);
+}
+
+lut::Rgb8 SpiralImage::sampleRotated(uint16_t logical, uint16_t rotation) const
+{
+  const Tap &tap = taps[logical];
+  uint32_t angle = (tap.angle + ((static_cast<uint32_t>(rotation) * PolarAngles) >> 8)) % (PolarAngles << 8);
+
+  uint8_t a0 = angle >> 8;
+  uint8_t a1 = (a0 + 1) % PolarAngles;
+  uint8_t r0 = tap.radius >> 8;
+  uint8_t r1 = r0 + 1 < PolarRadii ? r0 + 1 : r0;
+  return blend(polar[r0][a0], polar[r0][a1], polar[r1][a0], polar[r1][a1], angle & 0xFF, tap.radius & 0xFF);
+}
@@ -0,0 +1,72 @@
+#include "timeline.h"
+
+namespace
+{
+  uint8_t interpolate(const Keyframe &from, const Keyframe &to, uint32_t positionMs)
+  {
+    if (from.curve == curveOf(KeyCurve::Step) || to.timeMs <= from.timeMs)
+    {
+      return from.value;
+    }
+
+    uint32_t span = to.timeMs - from.timeMs;
+    uint8_t progress = static_cast<uint8_t>((static_cast<uint64_t>(positionMs - from.timeMs) * 255) / span);
+    Easing easing = from.curve < static_cast<uint8_t>(Easing::Count) ? static_cast<Easing>(from.curve) : Easing::Linear;
+    int32_t weight = easing::ease(easing, progress);
+    return static_cast<uint8_t>(from.value + ((static_cast<int32_t>(to.value) - from.value) * weight) / 255);
+  }
+}
+
+void TimelinePlayer::load(const Timeline *next)
+{
+  timeline = next;
+  lastPositionMs = 0;
+  for (uint8_t &cursor : cursors)
+  {
+    cursor = 0;
+  }
+}
+
+void TimelinePlayer::evaluate(uint32_t positionMs, uint8_t values[static_cast<uint8_t>(TimelineParam::Count)])
+{
+  if (!timeline)
+  {
+    return;
+  }
+
+  if (timeline->loop && timeline->durationMs)
+  {
+    positionMs %= timeline->durationMs;
+  }
+
+  bool rewound = positionMs < lastPositionMs;
+  lastPositionMs = positionMs;
+
+  uint8_t trackCount = timeline->trackCount < MaxTracks ? timeline->trackCount : MaxTracks;
+  for (uint8_t index = 0; index < trackCount; ++index)
+  {
+    const TimelineTrack &track = timeline->tracks[index];
+    if (track.keyCount == 0)
+    {
+      continue;
+    }
+
+    uint8_t &cursor = cursors[index];
+    if (rewound)
+    {
+      cursor = 0;
+    }
+    while (cursor + 1 < track.keyCount && track.keys[cursor + 1].timeMs <= positionMs)
+    {
+      ++cursor;
+    }
+
+    const Keyframe &from = track.keys[cursor];
+    uint8_t value = from.value;
+    if (positionMs > from.timeMs && cursor + 1 < track.keyCount)
+    {
+      value = interpolate(from, track.keys[cursor + 1], positionMs);
+    }
+    values[static_cast<uint8_t>(track.param)] = value;
+  }
+}